@@ -0,0 +1,235 @@
+/*
+ * Copyright (c) 2010 Frantisek Simancik
+ * <frantisek.simancik@comlab.ox.ac.uk>, Yevgeny Kazakov
+ * <yevgeny.kazakov@comlab.ox.ac.uk> and University of Oxford
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+// Generator of synthetic SH ontologies in OWL2 functional-style syntax,
+// one axiom per line, for measuring how the reasoner scales.
+//
+// The concepts form a told taxonomy; every concept has a number of
+// existential restrictions, some are defined as conjunctions with an
+// existential restriction, and a share of them get a disjunction or a
+// universal restriction. The roles form a hierarchy of the given depth and
+// the first roles are transitive. The same options and seed always give
+// the same ontology.
+//
+// With -l, the ontology is instead a layered one of disjoint concepts, for
+// the splitting of concepts with many binary axioms (Ontology::split).
+
+#include <iostream>
+#include <sstream>
+#include <string>
+#include <cstring>
+#include <cstdlib>
+
+using namespace std;
+
+int CONCEPTS = 1000;
+int ROLES = 10;
+int DEPTH = 3;
+int TRANSITIVE = 2;
+int FANOUT = 2;
+int DEFINED = 10;     //percent of concepts
+int DISJUNCTIONS = 2; //percent of concepts
+int UNIVERSALS = 1;   //percent of concepts
+int WINDOW = 100;     //concepts per module
+int LAYERED = 0;      //subclasses of the bottom layer, none for the random ontology
+int MIDDLE = 150;     //subclasses of each concept of the middle layer
+unsigned long long SEED = 1;
+
+const string PREFIX = "http://condor.example.org/generated#";
+
+//xorshift, so that the output does not depend on the C library
+unsigned long long state;
+
+unsigned draw(unsigned n) {
+    state ^= state << 13;
+    state ^= state >> 7;
+    state ^= state << 17;
+    return (unsigned) (state % n);
+}
+
+bool chance(int percent) {
+    return (int) draw(100) < percent;
+}
+
+string iri(const char* kind, int i) {
+    ostringstream s;
+    s << "<" << PREFIX << kind << i << ">";
+    return s.str();
+}
+
+string concept(int i) {
+    return iri("C", i);
+}
+
+string role(int i) {
+    return iri("R", i);
+}
+
+string some(int r, int c) {
+    return "ObjectSomeValuesFrom(" + role(r) + " " + concept(c) + ")";
+}
+
+string all(int r, int c) {
+    return "ObjectAllValuesFrom(" + role(r) + " " + concept(c) + ")";
+}
+
+//The concepts are split into modules of WINDOW consecutive concepts. Fillers
+//are taken from the same module and only the first concept of a module has a
+//told subsumer outside of it, so the contexts do not grow with the size.
+
+int module(int i) {
+    return i / WINDOW * WINDOW;
+}
+
+//a told subsumer of i, earlier in the order
+int above(int i) {
+    if (i == 0)
+	return 0;
+    if (i == module(i))
+	return draw(i);
+    return module(i) + draw(i - module(i));
+}
+
+int near(int i) {
+    int first = module(i);
+    int n = CONCEPTS - first < WINDOW ? CONCEPTS - first : WINDOW;
+    return first + draw(n);
+}
+
+void generate(ostream& out) {
+    state = SEED * 2685821657736338717ULL + 1;
+
+    out << "Prefix(owl:=<http://www.w3.org/2002/07/owl#>)" << endl;
+    out << "Ontology(<http://condor.example.org/generated>" << endl;
+
+    for (int i = 0; i < ROLES; i++)
+	out << "Declaration(ObjectProperty(" << role(i) << "))" << endl;
+    for (int i = 0; i < CONCEPTS; i++)
+	out << "Declaration(Class(" << concept(i) << "))" << endl;
+
+    //roles are split into DEPTH levels, every role below one of the level above
+    int depth = DEPTH > 0 ? DEPTH : 1;
+    int level = ROLES > depth ? (ROLES + depth - 1) / depth : 1;
+    for (int i = level; i < ROLES; i++)
+	out << "SubObjectPropertyOf(" << role(i) << " " << role(i / level * level - level + draw(level)) << ")" << endl;
+    for (int i = 0; i < TRANSITIVE && i < ROLES; i++)
+	out << "TransitiveObjectProperty(" << role(i) << ")" << endl;
+
+    for (int i = 1; i < CONCEPTS; i++)
+	out << "SubClassOf(" << concept(i) << " " << concept(above(i)) << ")" << endl;
+
+    for (int i = 0; i < CONCEPTS; i++) {
+	if (ROLES > 0) {
+	    for (int k = 0; k < FANOUT; k++)
+		out << "SubClassOf(" << concept(i) << " " << some(draw(ROLES), near(i)) << ")" << endl;
+	    if (chance(DEFINED))
+		out << "EquivalentClasses(" << concept(i) << " ObjectIntersectionOf(" << concept(above(i)) << " " << some(draw(ROLES), near(i)) << "))" << endl;
+	    if (chance(UNIVERSALS))
+		out << "SubClassOf(" << concept(i) << " " << all(draw(ROLES), near(i)) << ")" << endl;
+	}
+	if (chance(DISJUNCTIONS))
+	    out << "SubClassOf(" << concept(i) << " ObjectUnionOf(" << concept(near(i)) << " " << concept(near(i)) << "))" << endl;
+    }
+
+    out << ")" << endl;
+}
+
+//A concept with LAYERED subclasses is disjoint with the two concepts of the
+//middle layer, which have MIDDLE subclasses each and are disjoint with the two
+//concepts of the top layer. Every disjointness is a binary axiom for all the
+//subclasses, so the cost model of Ontology::split decides which of the
+//concepts are moved to dummies, and which of their partners go with them.
+void layered(ostream& out) {
+    out << "Prefix(owl:=<http://www.w3.org/2002/07/owl#>)" << endl;
+    out << "Ontology(<http://condor.example.org/generated>" << endl;
+
+    //C0 is the bottom layer, C1 and C2 the middle one, C3 and C4 the top one
+    for (int m = 1; m <= 2; m++) {
+	out << "DisjointClasses(" << concept(0) << " " << concept(m) << ")" << endl;
+	for (int t = 3; t <= 4; t++)
+	    out << "DisjointClasses(" << concept(m) << " " << concept(t) << ")" << endl;
+    }
+    int next = 5;
+    for (int m = 1; m <= 2; m++)
+	for (int i = 0; i < MIDDLE; i++)
+	    out << "SubClassOf(" << concept(next++) << " " << concept(m) << ")" << endl;
+    for (int i = 0; i < LAYERED; i++)
+	out << "SubClassOf(" << concept(next++) << " " << concept(0) << ")" << endl;
+
+    out << ")" << endl;
+}
+
+void help() {
+    cout << "Usage: generate [options] > ontology.owl" << endl;
+    cout << endl;
+    cout << "-c  number of concepts (" << CONCEPTS << ")" << endl;
+    cout << "-r  number of roles (" << ROLES << ")" << endl;
+    cout << "-d  depth of the role hierarchy (" << DEPTH << ")" << endl;
+    cout << "-t  number of transitive roles (" << TRANSITIVE << ")" << endl;
+    cout << "-e  existential restrictions per concept (" << FANOUT << ")" << endl;
+    cout << "-q  percent of concepts defined by a conjunction (" << DEFINED << ")" << endl;
+    cout << "-j  percent of concepts with a disjunction (" << DISJUNCTIONS << ")" << endl;
+    cout << "-u  percent of concepts with a universal restriction (" << UNIVERSALS << ")" << endl;
+    cout << "-w  concepts per module, fillers are taken from the same module (" << WINDOW << ")" << endl;
+    cout << "-s  seed of the random numbers (" << SEED << ")" << endl;
+    cout << "-l  instead, a layered ontology of disjoint concepts with this many subclasses" << endl;
+    cout << "    of the bottom layer (" << LAYERED << ")" << endl;
+    cout << "-k  subclasses of each concept of the middle layer with -l (" << MIDDLE << ")" << endl;
+}
+
+int main(int argc, char* argv[]) {
+    for (int i = 1; i < argc; i++) {
+	if (strcmp(argv[i], "-h") == 0 || strcmp(argv[i], "--help") == 0) {
+	    help();
+	    return 0;
+	}
+	if (argv[i][0] != '-' || strlen(argv[i]) != 2 || i + 1 == argc || atoi(argv[i+1]) < 0) {
+	    cerr << "Error: bad argument " << argv[i] << endl;
+	    help();
+	    return 1;
+	}
+	int value = atoi(argv[++i]);
+	switch (argv[i-1][1]) {
+	    case 'c': CONCEPTS = value; break;
+	    case 'r': ROLES = value; break;
+	    case 'd': DEPTH = value; break;
+	    case 't': TRANSITIVE = value; break;
+	    case 'e': FANOUT = value; break;
+	    case 'q': DEFINED = value; break;
+	    case 'j': DISJUNCTIONS = value; break;
+	    case 'u': UNIVERSALS = value; break;
+	    case 'w': WINDOW = value; break;
+	    case 's': SEED = value; break;
+	    case 'l': LAYERED = value; break;
+	    case 'k': MIDDLE = value; break;
+	    default:
+		cerr << "Error: unknown option " << argv[i-1] << endl;
+		help();
+		return 1;
+	}
+    }
+    if (CONCEPTS == 0 || WINDOW == 0) {
+	cerr << "Error: at least one concept and a positive window are needed" << endl;
+	return 1;
+    }
+    if (LAYERED)
+	layered(cout);
+    else
+	generate(cout);
+    return 0;
+}
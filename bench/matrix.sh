@@ -0,0 +1,126 @@
+#!/bin/sh
+#
+# Copyright (c) 2010 Frantisek Simancik
+# <frantisek.simancik@comlab.ox.ac.uk>, Yevgeny Kazakov
+# <yevgeny.kazakov@comlab.ox.ac.uk> and University of Oxford
+#
+# Licensed under the Apache License, Version 2.0 (the "License");
+# you may not use this file except in compliance with the License.
+# You may obtain a copy of the License at
+#
+# http://www.apache.org/licenses/LICENSE-2.0
+#
+# Unless required by applicable law or agreed to in writing, software
+# distributed under the License is distributed on an "AS IS" BASIS,
+# WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+# See the License for the specific language governing permissions and
+# limitations under the License.
+#
+# Classifies every ontology with all combinations of the switches -sub, -rem,
+# -top and -sc, and writes one CSV row per run with the time, the memory and
+# the counters of the -l log. Every taxonomy is compared with the one of the
+# default configuration. At the end, prints the fastest configuration whose
+# taxonomies are all the same as the default ones.
+#
+# usage: matrix.sh CONDOR OUTPUT.csv ONTOLOGY...
+# CONDOR_FLAGS are passed to every run; TIMEOUT limits a run, in seconds
+# (60 by default, some configurations do not terminate in practice).
+
+condor=`cd \`dirname $1\` && pwd`/`basename $1`
+csv=$2
+shift 2
+
+work=${TMPDIR:-/tmp}/condor-matrix.$$
+mkdir -p $work || exit 1
+trap 'rm -rf $work' EXIT
+
+limit=""
+if command -v timeout > /dev/null; then
+    limit="timeout ${TIMEOUT:-60}"
+fi
+
+#the first number after a label of condor.log
+logged() {
+    sed -n "s/^$1: \([0-9.]*\).*/\1/p" $work/condor.log
+}
+
+#both numbers after a label of condor.log, for root and successor contexts
+logged2() {
+    sed -n "s/^$1: \([0-9.]*\) \([0-9.]*\).*/\1,\2/p" $work/condor.log
+}
+
+#a number of the statistics
+value() {
+    sed -n "s/.*\"$1\": [{ ]*\(\"bytes\": [0-9]*, \"peak_bytes\": \)\{0,1\}\([0-9.]*\).*/\2/p" $work/stats.json | head -1
+}
+
+#default configuration first, it is the baseline
+configs="-sub1_-rem0_-top0_-sc0"
+for sub in 0 1; do
+    for rem in 0 1; do
+	for top in 0 1; do
+	    for sc in 0 1; do
+		c="-sub${sub}_-rem${rem}_-top${top}_-sc${sc}"
+		[ $c = "-sub1_-rem0_-top0_-sc0" ] || configs="$configs $c"
+	    done
+	done
+    done
+done
+
+echo "ontology,flags,status,wall_ms,classification_ms,peak_bytes,max_rss_kb,contexts_root,contexts_successor,clauses_root,clauses_successor,max_clauses_root,max_clauses_successor,avg_links,max_forward_links,max_backward_links,max_topush" > $csv
+for f in "$@"; do
+    ontology=`cd \`dirname $f\` && pwd`/`basename $f`
+    name=`basename $f`
+    for c in $configs; do
+	flags=`echo $c | tr _ ' '`
+	rm -f $work/condor.log $work/stats.json $work/taxonomy.owl
+	start=`date +%s%N`
+	(cd $work && $limit $condor -i $ontology -o $work/taxonomy.owl -l -s $work/stats.json $flags $CONDOR_FLAGS 2> $work/err)
+	code=$?
+	end=`date +%s%N`
+	if [ $code -ne 0 ] || [ ! -f $work/condor.log ]; then
+	    [ $code -eq 124 ] && status=timeout || status=failed
+	    echo "$name,$flags,$status,,,,,,,,,,,,,," >> $csv
+	    echo "$name $flags: $status" >&2
+	    continue
+	fi
+	if [ $c = "-sub1_-rem0_-top0_-sc0" ]; then
+	    cp $work/taxonomy.owl $work/baseline.owl
+	    status=baseline
+	elif cmp -s $work/taxonomy.owl $work/baseline.owl; then
+	    status=same
+	else
+	    status=different
+	fi
+	echo "$name,$flags,$status,$(( (end - start) / 1000000 )),`logged "Classification time"`,`value total`,`value max_rss_kb`,`logged2 Contexts`,`logged2 Axioms`,`logged2 "Max axioms"`,`logged "Avg links"`,`logged "Max forward links"`,`logged "Max backward links"`,`logged "Max topush"`" >> $csv
+	echo "$name $flags: $status $(( (end - start) / 1000000 ))ms" >&2
+    done
+done
+
+#total time per configuration over the ontologies where none failed or differed
+awk -F, 'NR > 1 {
+	if (!runs[$2])
+	    order[n++] = $2
+	runs[$2]++
+	if ($3 == "baseline" || $3 == "same")
+	    total[$2] += $4
+	else
+	    bad[$2]++
+	if ($3 == "baseline")
+	    base += $4
+    }
+    END {
+	best = ""
+	for (i = 0; i < n; i++) {
+	    c = order[i]
+	    if (!bad[c] && (best == "" || total[c] < total[best]))
+		best = c
+	}
+	for (i = 0; i < n; i++)
+	    if (bad[c = order[i]])
+		printf "%s: %d of %d taxonomies missing or different\n", c, bad[c], runs[c]
+	if (best == "")
+	    print "No configuration agrees with the default one."
+	else
+	    printf "Recommended: %s (%d ms, default %d ms)\n", best, total[best], base
+    }' $csv
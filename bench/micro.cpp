@@ -0,0 +1,397 @@
+/*
+ * Copyright (c) 2010 Frantisek Simancik
+ * <frantisek.simancik@comlab.ox.ac.uk>, Yevgeny Kazakov
+ * <yevgeny.kazakov@comlab.ox.ac.uk> and University of Oxford
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+// Microbenchmarks of the data structures of the reasoner: clauses
+// (Disjunction), interning (tracker, slab_tracker, hash_tracker), role
+// hierarchy, taxonomy, concept lookups and the reduction of the subsumers
+// to the direct ones (Formatter). The data is prepared before
+// timing, with the mix of concept types and the clause lengths of a typical
+// saturation, and every benchmark is repeated to report the median and the
+// fastest run.
+
+#include <iostream>
+#include <iomanip>
+#include <vector>
+#include <set>
+#include <string>
+#include <sstream>
+#include <algorithm>
+#include <cstring>
+#include <cstdlib>
+
+#include "header.h"
+#include "tracker.h"
+#include "role.h"
+#include "concept.h"
+#include "disjunction.h"
+#include "factory.h"
+#include "stats.h"
+#include "taxonomy.h"
+#include "formatter.h"
+
+using namespace std;
+
+int SIZE = 100000;  //operations per run
+int RUNS = 7;
+unsigned long long SEED = 1;
+const char* FILTER = "";
+
+Factory factory;
+RoleHierarchy hierarchy;
+
+//the results are summed here so that no benchmark is optimized away
+long long sink = 0;
+
+unsigned long long state;
+
+unsigned draw(unsigned n) {
+    state ^= state << 13;
+    state ^= state >> 7;
+    state ^= state << 17;
+    return (unsigned) (state % n);
+}
+
+//few elements are used often and most of them rarely
+unsigned skewed(unsigned n) {
+    double u = draw(1 << 20) / double(1 << 20);
+    return (unsigned) (u * u * u * n);
+}
+
+vector<const Role*> roles;
+vector<ConceptID> ids;  //as they occur in clauses, some with the decompose flag
+vector<set<ConceptID, Concept::DecomposeLess> > sets;
+vector<Disjunction> clauses, premises, others;
+vector<pair<RoleID, ConceptID> > keys;
+vector<string> names;
+vector<pair<RoleID, RoleID> > role_pairs;
+Taxonomy* taxonomy;
+vector<pair<int, int> > class_pairs;
+vector<const AtomicConcept*> classes;
+vector<vector<int> > closed_lists, open_lists;
+
+//the taxonomy written by Formatter from these subsumers of the atomic concepts
+string reduce(const vector<vector<int> >& lists) {
+    Formatter f;
+    f.init(classes);
+    for (int i = 0; i < lists.size(); i++)
+	FOREACH(j, lists[i])
+	    f.subsumption(classes[i], classes[*j]);
+    ostringstream s;
+    f.write(s);
+    return s.str();
+}
+
+//mostly unit clauses, as derived in the contexts
+int length() {
+    int r = draw(100);
+    if (r < 50)
+	return 1;
+    if (r < 80)
+	return 2;
+    if (r < 92)
+	return 3;
+    return 4 + draw(5);
+}
+
+set<ConceptID, Concept::DecomposeLess> clause(int n) {
+    set<ConceptID, Concept::DecomposeLess> s;
+    while (s.size() < n)
+	s.insert(ids[skewed(ids.size())]);
+    return s;
+}
+
+//a clause that contains c, so that it can be a premise of a resolution on c
+Disjunction premise(ConceptID c) {
+    set<ConceptID, Concept::DecomposeLess> s = clause(length());
+    s.erase(c);
+    s.insert(c);
+    return Disjunction(s);
+}
+
+void prepare() {
+    state = SEED * 2685821657736338717ULL + 1;
+
+    //roles in a hierarchy of four levels
+    int n_roles = 40;
+    for (int i = 0; i < n_roles; i++) {
+	ostringstream s;
+	s << "r" << i;
+	roles.push_back(factory.role(s.str()));
+	if (i >= n_roles / 4)
+	    hierarchy.add(roles[i], roles[i - n_roles / 4 - i % (n_roles / 4) + draw(n_roles / 4)]);
+    }
+    hierarchy.closure();
+
+    //atomic concepts, and existentials, universals and negations over them
+    int n_atomic = SIZE / 10 + 1;
+    vector<const Concept*> atomic;
+    for (int i = 0; i < n_atomic; i++) {
+	ostringstream s;
+	s << "A" << i;
+	names.push_back(s.str());
+	atomic.push_back(factory.atomic(s.str()));
+    }
+    for (int i = 0; i < n_atomic; i++) {
+	const Concept* a = atomic[skewed(n_atomic)];
+	int r = draw(100);
+	if (r < 55)
+	    ids.push_back(a->ID());
+	else if (r < 85)
+	    ids.push_back(Concept::concept_decompose(factory.existential(roles[draw(n_roles)], a)));
+	else if (r < 95)
+	    ids.push_back(Concept::concept_decompose(factory.negation(a)));
+	else
+	    ids.push_back(Concept::concept_decompose(factory.universal(roles[draw(n_roles)], a)));
+    }
+
+    for (int i = 0; i < SIZE; i++) {
+	sets.push_back(clause(length()));
+	clauses.push_back(Disjunction(sets.back()));
+    }
+    //premises resolve on the first literal, others are subsets in half of the cases
+    for (int i = 0; i < SIZE; i++) {
+	const Disjunction& d = clauses[i];
+	ConceptID c = d.front();
+	premises.push_back(premise(c));
+	if (draw(2) == 0) {
+	    set<ConceptID, Concept::DecomposeLess> s(d.begin(), d.end());
+	    set<ConceptID, Concept::DecomposeLess> extra = clause(length());
+	    s.insert(extra.begin(), extra.end());
+	    others.push_back(Disjunction(s));
+	}
+	else
+	    others.push_back(clauses[draw(SIZE)]);
+    }
+
+    //every key is interned about four times
+    for (int i = 0; i < SIZE; i++) {
+	keys.push_back(make_pair(roles[draw(n_roles)]->ID(), ids[skewed(SIZE / 4 < ids.size() ? SIZE / 4 : ids.size())]));
+	role_pairs.push_back(make_pair(roles[draw(n_roles)]->ID(), roles[draw(n_roles)]->ID()));
+    }
+
+    //a taxonomy of the atomic concepts, every tenth with a second parent;
+    //half of the queries ask for a subsumer
+    vector<int> rep(n_atomic);
+    vector<vector<int> > parents(n_atomic);
+    for (int i = 0; i < n_atomic; i++) {
+	rep[i] = i;
+	if (i > 0)
+	    parents[i].push_back(i - 1 - skewed(i));
+	if (i > 1 && draw(10) == 0 && parents[i][0] != i - 1)
+	    parents[i].push_back(i - 1);
+    }
+    taxonomy = new Taxonomy(names, rep, parents);
+    for (int i = 0; i < SIZE; i++) {
+	int c = draw(n_atomic);
+	int d = draw(2) == 0 && !parents[c].empty() ? parents[c][0] : draw(n_atomic);
+	class_pairs.push_back(make_pair(c, d));
+    }
+
+    //the subsumers of the atomic concepts in the tree of their first parents;
+    //every fifth concept whose parent has all its subsumers lists only the
+    //parent, so the open lists are not closed
+    vector<bool> partial(n_atomic, false);
+    closed_lists.resize(n_atomic);
+    open_lists.resize(n_atomic);
+    for (int i = 0; i < n_atomic; i++) {
+	classes.push_back((const AtomicConcept*) atomic[i]);
+	if (i == 0)
+	    continue;
+	int p = parents[i][0];
+	closed_lists[i] = closed_lists[p];
+	closed_lists[i].push_back(p);
+	partial[i] = !partial[p] && draw(5) == 0;
+	open_lists[i] = partial[i] ? parents[i] : closed_lists[i];
+	if (partial[i])
+	    open_lists[i].resize(1);
+    }
+    if (reduce(open_lists) != reduce(closed_lists)) {
+	cerr << "Error: Formatter reduces the open lists to another taxonomy" << endl;
+	exit(1);
+    }
+}
+
+struct Node {
+    int index;
+    explicit Node(const pair<RoleID, ConceptID>&) {}
+    explicit Node(const string&) {}
+};
+
+struct KeyHash {
+    size_t operator()(const pair<RoleID, ConceptID>& x) const {
+	return (size_t) x.second * 31 + x.first;
+    }
+};
+
+void construct() {
+    FOREACH(s, sets) {
+	Disjunction d(*s);
+	sink += d.size();
+    }
+}
+
+void resolve_unary() {
+    for (int i = 0; i < SIZE; i++)
+	sink += clauses[i].resolve(premises[i]).size();
+}
+
+void resolve_binary() {
+    for (int i = 0; i < SIZE; i++)
+	sink += clauses[i].resolve(premises[i], premises[SIZE - 1 - i]).size();
+}
+
+void subset() {
+    for (int i = 0; i < SIZE; i++)
+	sink += clauses[i].subset(others[i]);
+}
+
+void less_than() {
+    for (int i = 0; i < SIZE; i++)
+	sink += clauses[i] < others[i];
+}
+
+void set_insert() {
+    set<Disjunction> s;
+    FOREACH(d, clauses)
+	s.insert(*d);
+    sink += s.size();
+}
+
+void tracker_intern() {
+    tracker<pair<RoleID, ConceptID>, Node> t;
+    FOREACH(k, keys) {
+	t(*k);
+	sink += t.was_new();
+    }
+}
+
+void slab_tracker_intern() {
+    slab_tracker<pair<RoleID, ConceptID>, Node, Memory::FACTORY, KeyHash> t;
+    FOREACH(k, keys) {
+	t(*k);
+	sink += t.was_new();
+    }
+}
+
+void hash_tracker_intern() {
+    hash_tracker<string, Node> t;
+    for (int i = 0; i < SIZE; i++) {
+	t(names[skewed(names.size())]);
+	sink += t.was_new();
+    }
+}
+
+void hierarchy_query() {
+    FOREACH(p, role_pairs)
+	sink += hierarchy(p->first, p->second);
+}
+
+void taxonomy_query() {
+    FOREACH(p, class_pairs)
+	sink += taxonomy->subsumed(p->first, p->second);
+}
+
+void formatter_reduce() {
+    sink += reduce(open_lists).size();
+}
+
+void concept_lookup() {
+    for (int i = 0; i < SIZE; i++)
+	sink += factory.concept(ids[i % ids.size()])->type();
+}
+
+struct Benchmark {
+    const char* name;
+    void (*run)();
+};
+
+Benchmark benchmarks[] = {
+    { "disjunction_construct", construct },
+    { "disjunction_resolve_unary", resolve_unary },
+    { "disjunction_resolve_binary", resolve_binary },
+    { "disjunction_subset", subset },
+    { "disjunction_less", less_than },
+    { "disjunction_set_insert", set_insert },
+    { "tracker_intern", tracker_intern },
+    { "slab_tracker_intern", slab_tracker_intern },
+    { "hash_tracker_intern", hash_tracker_intern },
+    { "hierarchy_query", hierarchy_query },
+    { "taxonomy_query", taxonomy_query },
+    { "factory_concept", concept_lookup },
+    { "formatter_reduce", formatter_reduce },
+};
+
+void help() {
+    cout << "Usage: micro [options]" << endl;
+    cout << endl;
+    cout << "-n  operations per run (" << SIZE << ")" << endl;
+    cout << "-r  runs of every benchmark (" << RUNS << ")" << endl;
+    cout << "-s  seed of the random numbers (" << SEED << ")" << endl;
+    cout << "-b  run only the benchmarks whose name contains this" << endl;
+}
+
+int main(int argc, char* argv[]) {
+    for (int i = 1; i < argc; i++) {
+	if (strcmp(argv[i], "-h") == 0 || strcmp(argv[i], "--help") == 0) {
+	    help();
+	    return 0;
+	}
+	if (argv[i][0] != '-' || strlen(argv[i]) != 2 || i + 1 == argc) {
+	    cerr << "Error: bad argument " << argv[i] << endl;
+	    help();
+	    return 1;
+	}
+	const char* value = argv[++i];
+	switch (argv[i-1][1]) {
+	    case 'n': SIZE = atoi(value); break;
+	    case 'r': RUNS = atoi(value); break;
+	    case 's': SEED = atoi(value); break;
+	    case 'b': FILTER = value; break;
+	    default:
+		cerr << "Error: unknown option " << argv[i-1] << endl;
+		help();
+		return 1;
+	}
+    }
+    if (SIZE < 4 || RUNS < 1) {
+	cerr << "Error: at least 4 operations and one run are needed" << endl;
+	return 1;
+    }
+
+    prepare();
+
+    cout << left << setw(30) << "benchmark" << right << setw(14) << "median ns/op" << setw(12) << "min" << setw(12) << "max" << endl;
+    cout.setf(ios::fixed);
+    cout.precision(1);
+    for (int b = 0; b < sizeof(benchmarks) / sizeof(Benchmark); b++) {
+	if (!strstr(benchmarks[b].name, FILTER))
+	    continue;
+	//the first run only warms up the caches
+	benchmarks[b].run();
+	vector<double> t;
+	for (int r = 0; r < RUNS; r++) {
+	    double start = Statistics::wall();
+	    benchmarks[b].run();
+	    t.push_back((Statistics::wall() - start) * 1e9 / SIZE);
+	}
+	sort(t.begin(), t.end());
+	cout << left << setw(30) << benchmarks[b].name << right << setw(14) << t[RUNS / 2] << setw(12) << t[0] << setw(12) << t[RUNS - 1] << endl;
+    }
+    cerr << "checksum " << sink << endl;
+    return 0;
+}
@@ -0,0 +1,58 @@
+#!/bin/sh
+#
+# Copyright (c) 2010 Frantisek Simancik
+# <frantisek.simancik@comlab.ox.ac.uk>, Yevgeny Kazakov
+# <yevgeny.kazakov@comlab.ox.ac.uk> and University of Oxford
+#
+# Licensed under the Apache License, Version 2.0 (the "License");
+# you may not use this file except in compliance with the License.
+# You may obtain a copy of the License at
+#
+# http://www.apache.org/licenses/LICENSE-2.0
+#
+# Unless required by applicable law or agreed to in writing, software
+# distributed under the License is distributed on an "AS IS" BASIS,
+# WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+# See the License for the specific language governing permissions and
+# limitations under the License.
+#
+# Classifies a generated ontology of every given size and writes one CSV row
+# per size with the time of the phases, the memory and the size of the result.
+#
+# usage: sweep.sh CONDOR GENERATE OUTPUT.csv SIZE...
+# GENERATE_FLAGS and CONDOR_FLAGS are passed to the two programs.
+
+condor=$1
+generate=$2
+csv=$3
+shift 3
+
+work=${TMPDIR:-/tmp}/condor-bench.$$
+mkdir -p $work || exit 1
+trap 'rm -rf $work' EXIT
+
+#value of a key in the statistics; phases give their wall time
+value() {
+    sed -n "s/.*\"$1\": [{ ]*\(\"wall_ms\": \|\"bytes\": [0-9]*, \"peak_bytes\": \)\{0,1\}\([0-9.]*\).*/\2/p" $work/stats.json | head -1
+}
+
+echo "concepts,axioms,status,wall_ms,parse_ms,normalize_ms,saturate_ms,output_ms,cpu_ms,peak_bytes,max_rss_kb,clauses,links,output_axioms" > $csv
+for n in "$@"; do
+    $generate -c $n $GENERATE_FLAGS > $work/ontology.owl || exit 1
+    axioms=`grep -c -v "^Declaration\|^Prefix\|^Ontology\|^)" $work/ontology.owl`
+    rm -f $work/stats.json
+    start=`date +%s%N`
+    $condor -i $work/ontology.owl -o $work/taxonomy.owl -s $work/stats.json $CONDOR_FLAGS 2> $work/log
+    status=$?
+    end=`date +%s%N`
+    if [ $status -ne 0 ] || [ ! -f $work/stats.json ]; then
+	echo "$n,$axioms,failed,,,,,,,,,,," >> $csv
+	echo "size $n failed" >&2
+	continue
+    fi
+    cpu=`sed -n 's/.*"cpu_ms": \([0-9.]*\).*/\1/p' $work/stats.json | awk '{ s += $1 } END { printf "%.3f", s }'`
+    clauses=$((`value clauses_root` + `value clauses_successor`))
+    out=`grep -c "^SubClassOf\|^EquivalentClasses" $work/taxonomy.owl`
+    echo "$n,$axioms,ok,$(( (end - start) / 1000000 )),`value parse`,`value normalize`,`value saturate`,`value output`,$cpu,`value total`,`value max_rss_kb`,$clauses,`value links`,$out" >> $csv
+    echo "size $n: $(( (end - start) / 1000000 ))ms" >&2
+done
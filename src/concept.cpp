@@ -20,8 +20,6 @@
 
 #include "sstream"
 
-const int offset = 1000000;
-
 const ConceptID Concept::annotated_mask = 1<<27;
 const ConceptID Concept::decompose_mask = 1<<28;
 const ConceptID Concept::normalize_mask = (1<<25)-1;
@@ -52,6 +52,12 @@ class Concept {
   static ConceptID maximal_ID();
   static ConceptID minimal_ID();
 
+  //every type of concepts has its own band of IDs, those of dummies made by
+  //minimal_ID() count down in the first one
+  static const ConceptID offset = 1000000;
+  static int band(ConceptID id);
+  static int serial(ConceptID id);
+
   static ConceptID normalize(ConceptID id);
   static ConceptID annotate(ConceptID id);
   static bool is_annotated(ConceptID id);
@@ -242,4 +248,12 @@ inline bool Concept::decompose(ConceptID id) {
     return (id & decompose_mask) != 0;
 }
 
+inline int Concept::band(ConceptID id) {
+    return id / offset;
+}
+
+inline int Concept::serial(ConceptID id) {
+    return id < offset ? offset - 1 - id : id % offset;
+}
+
 #endif /* CONCEPT_H_ */
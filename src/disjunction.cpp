@@ -25,18 +25,30 @@
 #include "header.h"
 #include "disjunction.h"
 
-const Disjunction Disjunction::bottom = Disjunction();
+const Disjunction Disjunction::bottom = Disjunction().freeze();
 
 const int Disjunction::has_annotated_mask = 1<<10;
 const int Disjunction::size_mask = Disjunction::has_annotated_mask-1;;
 const int Disjunction::reuse_offset = 1<<11;
-const int Disjunction::reuse_mask = ~(Disjunction::reuse_offset-1);
+const int Disjunction::frozen_mask = 1<<30;
+const int Disjunction::reuse_mask = (Disjunction::frozen_mask-1) & ~(Disjunction::reuse_offset-1);
 
 //extern string write_disjunction(const Disjunction&);
 
 void Disjunction::allocate(int n) {
 	t = new ConceptID[n+1];
 	t[0] = n;
+	Memory::allocated(Memory::DISJUNCTIONS, (n+1) * sizeof(ConceptID));
+}
+
+inline void Disjunction::release() {
+	Memory::released(Memory::DISJUNCTIONS, (size()+1) * sizeof(ConceptID));
+	delete[] t;
+}
+
+//resolvents are allocated for the largest size, only the used part is counted
+inline void Disjunction::shrink(int n) {
+	Memory::released(Memory::DISJUNCTIONS, (n - size()) * sizeof(ConceptID));
 }
 
 inline void Disjunction::from_set(const set<ConceptID, Concept::DecomposeLess>& s) {
@@ -52,28 +64,50 @@ inline void Disjunction::from_set(const set<ConceptID, Concept::DecomposeLess>&
 	}
 }
 
-Disjunction& Disjunction::operator=(const Disjunction& rhs) {
-    if ((t[0] & reuse_mask) == 0)
-	delete[] t;
+//one more copy; a clause with more copies than the counter holds is frozen,
+//so that the count cannot run into the frozen bit, and is never freed
+inline void Disjunction::reuse() const {
+    if (t[0] & frozen_mask)
+	return;
+    if ((t[0] & reuse_mask) == reuse_mask)
+	t[0] |= frozen_mask;
     else
-	t[0] -= reuse_offset;
+	t[0] += reuse_offset;
+}
+
+Disjunction& Disjunction::operator=(const Disjunction& rhs) {
+    rhs.reuse();
+    if ((t[0] & frozen_mask) == 0) {
+	if ((t[0] & reuse_mask) == 0)
+	    release();
+	else
+	    t[0] -= reuse_offset;
+    }
     t = rhs.t;
-    t[0] += reuse_offset;
     return *this;
 }
 
 Disjunction::Disjunction(const Disjunction& rhs) {
     t = rhs.t;
-    t[0] += reuse_offset;
+    reuse();
 }
 
 Disjunction::~Disjunction() {
+    if (t[0] & frozen_mask)
+	return;
     if ((t[0] & reuse_mask) == 0)
-	delete[] t;
+	release();
     else
 	t[0] -= reuse_offset;
 }
 
+//frozen disjunctions are neither counted nor freed, so copying them
+//does not write to memory shared with worker processes
+const Disjunction& Disjunction::freeze() const {
+    t[0] |= frozen_mask;
+    return *this;
+}
+
 Disjunction::Disjunction(bool bottom) {
     if (bottom)
 	allocate(0);
@@ -115,6 +149,12 @@ Disjunction::Disjunction(const vector<const Concept*>& v, bool decompose) {
     from_set(s);
 }
 
+//the literals in the given order, as they were written out
+Disjunction::Disjunction(const ConceptID* b, const ConceptID* e) {
+    allocate(e - b);
+    copy(b, e, t + 1);
+}
+
 bool Disjunction::operator==(const Disjunction& rhs) const {
 	if (size() != rhs.size())
 		return false;
@@ -182,6 +222,7 @@ Disjunction Disjunction::resolve(const Disjunction& a) const {
   }
 
     d.t[0] = k-d.t-1;
+    d.shrink(size()+a.size()-1);
     /*
       if (has_annotated() || a.has_annotated())
 	  d.t[0] |= has_annotated_mask;
@@ -230,6 +271,7 @@ Disjunction Disjunction::resolve(const Disjunction& a1, const Disjunction& a2) c
     }
 
     d.t[0] = k-d.t-1;
+    d.shrink(size()+a1.size()+a2.size()-2);
     /*
     if (has_annotated() || a1.has_annotated() || a2.has_annotated())
 	    d.t[0] |= has_annotated_mask;
@@ -24,6 +24,7 @@
 #include <string>
 
 #include "concept.h"
+#include "memory.h"
 
 using namespace std;
 
@@ -35,9 +36,13 @@ class Disjunction {
     static const int has_annotated_mask;
     static const int reuse_offset;
     static const int reuse_mask;
+    static const int frozen_mask;
   ConceptID* t;
 
   void allocate(int n);
+  void release();
+  void reuse() const;
+  void shrink(int n);
   void from_set(const set<ConceptID, Concept::DecomposeLess>&);
 
 public:
@@ -51,6 +56,7 @@ public:
   Disjunction(ConceptID c, ConceptID d);
   Disjunction(ConceptID c, Disjunction d);
   explicit Disjunction(const vector<const Concept*>& v, bool positive);
+  Disjunction(const ConceptID* b, const ConceptID* e);
   ~Disjunction();
   bool operator==(const Disjunction& rhs) const;
   bool operator!=(const Disjunction& rhs) const;
@@ -68,6 +74,7 @@ public:
   Disjunction resolve(const Disjunction& a) const;
   Disjunction resolve(const Disjunction& a1, const Disjunction &a2) const;
   Disjunction annotate() const;
+  const Disjunction& freeze() const;
 
 //  bool occurs(const unordered_multimap<ConceptID, Disjunction>& m) const;
   struct SizeLess {
@@ -41,8 +41,10 @@ class Factory {
   const TopConcept* top_tracker;
   const BottomConcept* bottom_tracker;
 
-  unordered_map<RoleID, const Role*> role_register;
-  unordered_map<ConceptID, const Concept*> concept_register;
+  unordered_map<RoleID, const Role*, std::tr1::hash<RoleID>, equal_to<RoleID>,
+      CountingAllocator<pair<const RoleID, const Role*>, Memory::FACTORY> > role_register;
+  unordered_map<ConceptID, const Concept*, std::tr1::hash<ConceptID>, equal_to<ConceptID>,
+      CountingAllocator<pair<const ConceptID, const Concept*>, Memory::FACTORY> > concept_register;
 
   public:
   hash_tracker<string, const AtomicConcept> atomic_tracker;
@@ -18,8 +18,15 @@
 
 #include <algorithm>
 #include <iterator>
+#include <cerrno>
+#include <cstring>
+#include <unistd.h>
 
 #include "formatter.h"
+#include "factory.h"
+#include "stats.h"
+
+extern Factory factory;
 
 template<typename T, typename S> 
 bool empty_intersection(const T& b1, const T& e1, const S& b2, const S& e2) {
@@ -40,9 +47,24 @@ void Formatter::init(const vector<const AtomicConcept*>& ord) {
     consistent = true;
     concepts = ord;
     n = concepts.size();
+    //atomic concepts have consecutive IDs
+    first = 0;
+    order.clear();
+    if (n > 0) {
+	first = concepts[0]->ID();
+	ConceptID last = first;
+	FOREACH(c, concepts) {
+	    first = min(first, (*c)->ID());
+	    last = max(last, (*c)->ID());
+	}
+	order.resize(last - first + 1, -1);
+    }
     for (int i = 0; i < n; i++)
-	order[concepts[i]->ID()] = i;
+	order[concepts[i]->ID() - first] = i;
     super.resize(n);
+    names.resize(n);
+    for (int i = 0; i < n; i++)
+	names[i] = concepts[i]->to_string();
 }
 
 /*
@@ -51,10 +73,12 @@ int subsum = 0;
 */
 
 void Formatter::unsatisfiable(const Concept* x) {
-	if (x->type() == 'A')
-		bot.insert(order[x->ID()]);
+	if (fd >= 0)
+		send('U', x->ID(), 0);
+	else if (x->type() == 'A')
+		bot.insert(index(x->ID()));
 	else if (x->type() == 'T')
-		consistent == false;
+		consistent = false;
 	else 
 		cerr << "Internal error: unexpected concept type for formatter" << endl;
 //    unsat++;
@@ -63,79 +87,311 @@ void Formatter::unsatisfiable(const Concept* x) {
 void Formatter::subsumption(const Concept* x, const AtomicConcept* y) {
 	if (x->ID() == y->ID())
 		return;
-	if (x->type() == 'A') 
-	    super[order[x->ID()]].push_back(order[y->ID()]);
+	if (fd >= 0)
+		send('S', x->ID(), y->ID());
+	else if (x->type() == 'A') 
+	    super[index(x->ID())].push_back(index(y->ID()));
 	else if (x->type() == 'T')
-		top.insert(y->ID());
+		top.insert(index(y->ID()));
 	else
 		cerr << "Internal error: Unexpected concept type for formatter" << endl;
 //  subsum++;
 }
 
+//x has the same subsumers as y, which is classified instead
+void Formatter::equivalent(const AtomicConcept* x, const AtomicConcept* y) {
+	equivalent_to.push_back(make_pair(index(x->ID()), index(y->ID())));
+}
+
+void Formatter::done(const Concept* x) {
+	if (fd >= 0)
+		send('G', x->ID(), 0);
+	else if (stream && x->type() == 'A')
+		finished(index(x->ID()));
+}
+
+//results of a worker process are passed to the parent as triples (kind, x, y):
+//  U x    x is unsatisfiable
+//  S x y  x is subsumed by y
+//  G x    the goal x is finished
+//  N x y  the next counter of the worker, with x its low and y its high half
+void Formatter::redirect(int fd) {
+	this->fd = fd;
+}
+
+void Formatter::send(ConceptID kind, ConceptID x, ConceptID y) {
+	buffer.push_back(kind);
+	buffer.push_back(x);
+	buffer.push_back(y);
+	if (buffer.size() >= 3*4096)
+		flush();
+}
+
+void Formatter::flush() {
+	if (buffer.empty())
+		return;
+	const char* p = (const char*) &buffer[0];
+	size_t n = buffer.size() * sizeof(ConceptID);
+	while (n > 0) {
+		ssize_t k = ::write(fd, p, n);
+		if (k < 0 && errno == EINTR)
+			continue;
+		if (k <= 0) {
+			cerr << "Error: cannot send results to the parent process" << endl;
+			_exit(1);
+		}
+		p += k;
+		n -= k;
+	}
+	buffer.clear();
+}
+
+//reads what is available from a worker; returns the number of finished goals or -1 at the end
+int Formatter::receive(int fd) {
+	char chunk[3*sizeof(ConceptID)*1024];
+	ssize_t k = ::read(fd, chunk, sizeof(chunk));
+	if (k < 0 && errno == EINTR)
+		return 0;
+	if (k <= 0) {
+		if (!incoming[fd].empty())
+			cerr << "Internal error: incomplete results from a worker process" << endl;
+		incoming.erase(fd);
+		return -1;
+	}
+
+	//records may be split between reads
+	string& in = incoming[fd];
+	in.append(chunk, k);
+	size_t record = 3*sizeof(ConceptID);
+	size_t complete = in.size() / record;
+
+	int goals = 0;
+	for (size_t i = 0; i < complete; i++) {
+		ConceptID r[3];
+		memcpy(r, in.data() + i*record, record);
+		if (r[0] == 'U')
+			unsatisfiable(factory.concept(r[1]));
+		else if (r[0] == 'S')
+			subsumption(factory.concept(r[1]), (const AtomicConcept*) factory.concept(r[2]));
+		else if (r[0] == 'N')
+			numbers[fd].push_back((long long) r[2] << 32 | (unsigned int) r[1]);
+		else {
+			goals++;
+			if (stream && factory.concept(r[1])->type() == 'A')
+				finished(index(r[1]));
+		}
+	}
+	in.erase(0, complete*record);
+	return goals;
+}
+
+//the statistics of a worker, sent when it is done
+void Formatter::send_counters(const vector<long long>& v) {
+	FOREACH(i, v)
+		send('N', (ConceptID) *i, (ConceptID) (*i >> 32));
+}
+
+//what a worker has sent with send_counters, once it has closed its pipe
+vector<long long> Formatter::counters(int fd) {
+	vector<long long> v;
+	v.swap(numbers[fd]);
+	numbers.erase(fd);
+	return v;
+}
+
+//classes that were not classified get the subsumers of their representatives
+void Formatter::collapse() {
+	FOREACH(i, equivalent_to) {
+		if (bot.find(i->second) != bot.end())
+			bot.insert(i->first);
+		else {
+			super[i->first] = super[i->second];
+			super[i->first].erase(remove(super[i->first].begin(), super[i->first].end(), i->first), super[i->first].end());
+			super[i->first].push_back(i->second);
+		}
+	}
+	equivalent_to.clear();
+}
+
+//equivalence classes, represented by their first member, and the direct
+//superclasses of the representatives
+void Formatter::build() {
+	if (built)
+		return;
+	built = true;
+	collapse();
+
+	rep.resize(n);
+	equivalents.resize(n);
+	parents.resize(n);
+	for (int i = 0; i < n; i++)
+		rep[i] = consistent ? i : NOTHING;
+	if (!consistent)
+		return;
+
+	FOREACH(i, bot)
+		rep[*i] = NOTHING;
+	FOREACH(i, top)
+		rep[*i] = THING;
+
+	for (int i = 0; i < n; i++)
+	    if (rep[i] == i) {
+		sort(super[i].begin(), super[i].end());
+		super[i].erase(unique(super[i].begin(), super[i].end()), super[i].end());
+	    }
+
+	for (int i = 0; i < n; i++)
+	    if (rep[i] == i)
+		FOREACH(j, super[i])
+		    if (binary_search(super[*j].begin(), super[*j].end(), i)) {
+			equivalents[i].push_back(*j);
+			if (rep[*j] == *j)
+			    rep[*j] = i;
+		    }
+
+	//a strict subsumer has fewer subsumers, so taking them from the most
+	//specific, only the subsumers of the direct ones are to be marked;
+	//a list may lack the subsumers of a parent whose own list has them,
+	//so the chosen ones are marked once more among themselves (checked
+	//by formatter_reduce in bench/micro.cpp)
+	vector<int> trans(n, -1);
+	vector<pair<int, int> > candidates;
+	vector<int> direct;
+	for (int i = 0; i < n; i++)
+	    if (rep[i] == i) {
+		candidates.clear();
+		FOREACH(j, super[i])
+		    if (rep[*j] == *j)
+			candidates.push_back(make_pair(-(int) super[*j].size(), *j));
+		sort(candidates.begin(), candidates.end());
+		direct.clear();
+		FOREACH(j, candidates)
+		    if (trans[j->second] != 2*i) {
+			direct.push_back(j->second);
+			FOREACH(k, super[j->second])
+			    trans[*k] = 2*i;
+		    }
+		FOREACH(j, direct)
+		    FOREACH(k, super[*j])
+			trans[*k] = 2*i + 1;
+		sort(direct.begin(), direct.end());
+		FOREACH(j, direct)
+		    if (trans[*j] != 2*i + 1)
+			parents[i].push_back(*j);
+	    }
+}
+
 void Formatter::write(ostream& output) {
-    /*
-    cerr << "unsatisfiable: " << unsat << endl;
-    cerr << "subsumptions: " << subsum << endl;
-    */
-	output << "Ontology(" << endl;
+	build();
+	Writer w(output);
+	w << "Ontology(\n";
 
 	if (!consistent) {
 		cerr << "The ontology is inconsistent." << endl;
-		output << "EquivalentClasses(owl:Nothing owl:Thing)" << endl;
+		w << "EquivalentClasses(owl:Nothing owl:Thing)\n";
 	}
 	else {
-		vector<bool> noneq(n, true);
 		if (!bot.empty()) {
-			output << "EquivalentClasses(owl:Nothing";
-			for (set<int>::iterator i = bot.begin(); i != bot.end(); i++) {
-				output << " " << concepts[*i]->to_string();
-				noneq[*i] = false;
-			}
-			output << ")" << endl;
+			w << "EquivalentClasses(owl:Nothing";
+			FOREACH(i, bot)
+				w << " " << names[*i];
+			w << ")\n";
 		}
 		if (!top.empty()) {
-			output << "EquivalentClasses(owl:Thing";
-			for (set<int>::iterator i = top.begin(); i != top.end(); i++) {
-				output << " " << concepts[*i]->to_string();
-				noneq[*i] = false;
-			}
-			output << ")" << endl;
+			w << "EquivalentClasses(owl:Thing";
+			FOREACH(i, top)
+				w << " " << names[*i];
+			w << ")\n";
 		}
-
 		for (int i = 0; i < n; i++)
-		    if (noneq[i]) {
-			sort(super[i].begin(), super[i].end());
-			super[i].erase(unique(super[i].begin(), super[i].end()), super[i].end());
-		    }
-
-		vector<int> v;
-		for (int i = 0; i < n; i++)
-		    if (noneq[i]) {
-			v.clear();
-			FOREACH(j, super[i])
-			    if (binary_search(super[*j].begin(), super[*j].end(), i))
-				v.push_back(*j);
-			if (!v.empty()) {
-			    output << "EquivalentClasses(" << concepts[i]->to_string();
-			    FOREACH(j, v) {
-				    output << " " << concepts[*j]->to_string();
-				    noneq[*j] = false;
-				}
-			    output << ")" << endl;
+			if (rep[i] == i && !equivalents[i].empty()) {
+				w << "EquivalentClasses(" << names[i];
+				FOREACH(j, equivalents[i])
+					w << " " << names[*j];
+				w << ")\n";
 			}
-		    }
-
-		vector<int> trans(n, -1);
 		for (int i = 0; i < n; i++)
-		    if (noneq[i]) {
-			FOREACH(j, super[i])
-			    if (noneq[*j] && trans[*j] != i)
-				FOREACH(k, super[*j])
-				    trans[*k] = i;
-			FOREACH(j, super[i])
-			    if (noneq[*j] && trans[*j] != i) 
-				output << "SubClassOf(" << concepts[i]->to_string() << " " << concepts[*j]->to_string() << ")" << endl;
-			}
+			if (rep[i] == i)
+				FOREACH(j, parents[i])
+					w << "SubClassOf(" << names[i] << " " << names[*j] << ")\n";
+	}
+	w << ")\n";
+}
+
+static string int32(int x) {
+	return string((const char*) &x, sizeof(x));
+}
+
+//In the byte order of the machine, all numbers 32-bit integers:
+//  "CONDOR01", consistent (0 or 1), the number of classes n,
+//  n names, each as its length and its characters,
+//  n representatives of the equivalence classes, -1 for those equivalent
+//    to owl:Nothing and -2 for those equivalent to owl:Thing,
+//  n+1 offsets into the parents, followed by the parents: the direct
+//    superclasses of a representative i are between offsets i and i+1.
+void Formatter::write_binary(ostream& output) {
+	build();
+	Writer w(output);
+	w << "CONDOR01" << int32(consistent) << int32(n);
+	for (int i = 0; i < n; i++)
+		w << int32(names[i].size()) << names[i];
+	for (int i = 0; i < n; i++)
+		w << int32(rep[i]);
+	int offset = 0;
+	for (int i = 0; i < n; i++) {
+		w << int32(offset);
+		offset += parents[i].size();
+	}
+	w << int32(offset);
+	for (int i = 0; i < n; i++)
+		FOREACH(j, parents[i])
+			w << int32(*j);
+}
+
+//for queries, to be deleted by the caller
+Taxonomy* Formatter::taxonomy() {
+	build();
+	return new Taxonomy(names, rep, parents);
+}
+
+//Every classified class is written with all its subsumers (not only the
+//direct ones) or as unsatisfiable. At the end come the classes that were
+//not classified, owl:Thing with the classes equivalent to it, which
+//subsume every class, and whether the ontology is inconsistent.
+void Formatter::open_stream(ostream& output) {
+	stream = new Writer(output);
+}
+
+void Formatter::finished(int i) {
+	Writer& w = *stream;
+	w << "{\"class\": " << Statistics::quote(names[i]);
+	if (bot.find(i) != bot.end())
+		w << ", \"unsatisfiable\": true}\n";
+	else {
+		sort(super[i].begin(), super[i].end());
+		super[i].erase(unique(super[i].begin(), super[i].end()), super[i].end());
+		w << ", \"subsumers\": [";
+		for (int j = 0; j < super[i].size(); j++)
+			w << (j ? ", " : "") << Statistics::quote(names[super[i][j]]);
+		w << "]}\n";
+	}
+}
+
+void Formatter::close_stream() {
+	vector<pair<int, int> > collapsed(equivalent_to);
+	collapse();
+	FOREACH(i, collapsed)
+		finished(i->first);
+	if (!top.empty()) {
+		*stream << "{\"class\": \"owl:Thing\", \"equivalents\": [";
+		FOREACH(i, top)
+			*stream << (i == top.begin() ? "" : ", ") << Statistics::quote(names[*i]);
+		*stream << "]}\n";
+	}
+	if (!consistent) {
+		cerr << "The ontology is inconsistent." << endl;
+		*stream << "{\"inconsistent\": true}\n";
 	}
-	output << ")" << endl;
+	delete stream;
+	stream = NULL;
 }
@@ -22,27 +22,94 @@
 #include <iostream>
 #include <set>
 #include <vector>
+#include <string>
 
 #include "header.h"
 #include "concept.h"
+#include "taxonomy.h"
 
 using namespace std;
 
+// Collects the results of the classification and writes the taxonomy:
+//  OWL     functional-style syntax, the default;
+//  BINARY  the names and direct superclasses as described at write_binary;
+//  JSONL   one JSON object per line, written as soon as a class is classified.
 class Formatter {
+  public:
+  enum Format { OWL, BINARY, JSONL };
+  class Writer;
+
+  private:
   bool consistent;
 
   int n;
-  unordered_map<ConceptID, int> order;
+  ConceptID first;
+  vector<int> order; //positions in concepts, by ID - first
+  int index(ConceptID id) const { return order[id - first]; }
   vector<const AtomicConcept *> concepts;
   vector< vector<int> > super;;
   set<int> bot, top;
+  vector<pair<int, int> > equivalent_to;
+
+  //the taxonomy, by build()
+  bool built;
+  vector<string> names;
+  vector<int> rep; //of the equivalence class, or below
+  static const int NOTHING = Taxonomy::NOTHING, THING = Taxonomy::THING;
+  vector<vector<int> > equivalents, parents; //of representatives
+  void collapse();
+  void build();
+
+  Writer* stream;
+  void finished(int i);
+
+  int fd;
+  vector<ConceptID> buffer;
+  unordered_map<int, string> incoming;
+  unordered_map<int, vector<long long> > numbers; //counters from the workers
+  void send(ConceptID kind, ConceptID x, ConceptID y);
 
 public:
+  Formatter() : built(false), stream(NULL), fd(-1) {}
 
   void init(const vector<const AtomicConcept*>& ord);
   void unsatisfiable(const Concept* x);
   void subsumption(const Concept* x, const AtomicConcept* y);
+  void done(const Concept* x);
+  void equivalent(const AtomicConcept* x, const AtomicConcept* y);
   void write(ostream &output = cout);
+  void write_binary(ostream& output);
+  void open_stream(ostream& output);
+  void close_stream();
+  Taxonomy* taxonomy();
+
+  void redirect(int fd);
+  void flush();
+  int receive(int fd);
+  void send_counters(const vector<long long>& v);
+  vector<long long> counters(int fd);
+};
+
+// Output collected in large blocks, instead of line by line.
+class Formatter::Writer {
+  ostream& output;
+  string block;
+
+  public:
+  explicit Writer(ostream& output) : output(output) {}
+  ~Writer() { flush(); }
+
+  Writer& operator<<(const string& s) {
+      block += s;
+      if (block.size() >= (1 << 20))
+	  flush();
+      return *this;
+  }
+  void flush() {
+      output.write(block.data(), block.size());
+      output.flush();
+      block.clear();
+  }
 };
 
 #endif /* FORMATTER_H_ */
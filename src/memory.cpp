@@ -0,0 +1,43 @@
+/*
+ * Copyright (c) 2010 Frantisek Simancik
+ * <frantisek.simancik@comlab.ox.ac.uk>, Yevgeny Kazakov
+ * <yevgeny.kazakov@comlab.ox.ac.uk> and University of Oxford
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <sstream>
+
+#include "memory.h"
+#include "stats.h"
+
+const char* Memory::names[SUBSYSTEMS] = { "factory", "ontology", "contexts", "disjunctions" };
+long long Memory::current[SUBSYSTEMS];
+long long Memory::peak[SUBSYSTEMS];
+long long Memory::total = 0;
+long long Memory::total_peak = 0;
+
+string Memory::megabytes(long long n) {
+    ostringstream s;
+    s.setf(ios::fixed);
+    s.precision(1);
+    s << n / 1048576.0 << "MB";
+    return s.str();
+}
+
+//as the members of a JSON object
+void Memory::write(ostream& output) {
+    for (int i = 0; i < SUBSYSTEMS; i++)
+	output << (i ? "," : "") << endl << "    " << Statistics::quote(names[i]) << ": { \"bytes\": " << current[i] << ", \"peak_bytes\": " << peak[i] << " }";
+    output << "," << endl << "    \"total\": { \"bytes\": " << total << ", \"peak_bytes\": " << total_peak << " }";
+}
@@ -0,0 +1,91 @@
+/*
+ * Copyright (c) 2010 Frantisek Simancik
+ * <frantisek.simancik@comlab.ox.ac.uk>, Yevgeny Kazakov
+ * <yevgeny.kazakov@comlab.ox.ac.uk> and University of Oxford
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef MEMORY_H_
+#define MEMORY_H_
+
+#include <cstddef>
+#include <memory>
+#include <iostream>
+#include <string>
+
+using namespace std;
+
+// Bytes currently held and the peak so far by each subsystem of the reasoner.
+// Containers count through CountingAllocator, the remaining structures
+// report their size themselves; overhead of the heap is not included.
+class Memory {
+  public:
+  enum Subsystem { FACTORY, ONTOLOGY, CONTEXTS, DISJUNCTIONS, SUBSYSTEMS };
+
+  static void allocated(int s, size_t n) {
+      current[s] += n;
+      if (current[s] > peak[s])
+	  peak[s] = current[s];
+      total += n;
+      if (total > total_peak)
+	  total_peak = total;
+  }
+  static void released(int s, size_t n) {
+      current[s] -= n;
+      total -= n;
+  }
+
+  static long long bytes(int s) { return current[s]; }
+  static long long peak_bytes(int s) { return peak[s]; }
+  static long long bytes() { return total; }
+  static long long peak_bytes() { return total_peak; }
+
+  static string megabytes(long long n);
+  static void write(ostream& output);
+
+  private:
+  static const char* names[SUBSYSTEMS];
+  static long long current[SUBSYSTEMS];
+  static long long peak[SUBSYSTEMS];
+  static long long total, total_peak;
+};
+
+// std::allocator that charges its blocks to a subsystem of Memory.
+template<typename T, int S>
+class CountingAllocator : public allocator<T> {
+  public:
+  template<typename U> struct rebind {
+      typedef CountingAllocator<U, S> other;
+  };
+
+  CountingAllocator() {}
+  CountingAllocator(const CountingAllocator&) {}
+  template<typename U> CountingAllocator(const CountingAllocator<U, S>&) {}
+
+  T* allocate(size_t n, const void* = 0) {
+      Memory::allocated(S, n * sizeof(T));
+      return allocator<T>::allocate(n);
+  }
+  void deallocate(T* p, size_t n) {
+      Memory::released(S, n * sizeof(T));
+      allocator<T>::deallocate(p, n);
+  }
+};
+
+template<typename T, typename U, int S>
+bool operator==(const CountingAllocator<T, S>&, const CountingAllocator<U, S>&) { return true; }
+template<typename T, typename U, int S>
+bool operator!=(const CountingAllocator<T, S>&, const CountingAllocator<U, S>&) { return false; }
+
+#endif /* MEMORY_H_ */
@@ -0,0 +1,215 @@
+/*
+ * Copyright (c) 2010 Frantisek Simancik
+ * <frantisek.simancik@comlab.ox.ac.uk>, Yevgeny Kazakov
+ * <yevgeny.kazakov@comlab.ox.ac.uk> and University of Oxford
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <queue>
+
+#include "ontology.h"
+
+//syntactic bottom-locality: symbols outside the signature are interpreted as empty
+class Ontology::Locality : public ConceptVisitor {
+  const unordered_set<ConceptID>& concepts;
+  const unordered_set<RoleID>& roles;
+  char value; // 'B' bottom-equivalent, 'T' top-equivalent, 0 otherwise
+
+  virtual void atomic(const AtomicConcept *c);
+  virtual void top(const TopConcept *c);
+  virtual void bottom(const BottomConcept *c);
+  virtual void negation(const NegationConcept *c);
+  virtual void conjunction(const ConjunctionConcept *c);
+  virtual void disjunction(const DisjunctionConcept *c);
+  virtual void existential(const ExistentialConcept *c);
+  virtual void universal(const UniversalConcept *c);
+  virtual void dummy(const DummyConcept *c);
+
+  public:
+  Locality(const unordered_set<ConceptID>& concepts, const unordered_set<RoleID>& roles) : concepts(concepts), roles(roles), value(0) {}
+  virtual ~Locality() {}
+  char operator()(const Concept *c) { c->accept(*this); return value; }
+};
+
+void Ontology::Locality::atomic(const AtomicConcept *c) {
+    value = (concepts.find(c->ID()) == concepts.end()) ? 'B' : 0;
+}
+
+void Ontology::Locality::top(const TopConcept *c) {
+    value = 'T';
+}
+
+void Ontology::Locality::bottom(const BottomConcept *c) {
+    value = 'B';
+}
+
+void Ontology::Locality::negation(const NegationConcept *c) {
+    char v = (*this)(c->concept());
+    value = (v == 'B') ? 'T' : (v == 'T') ? 'B' : 0;
+}
+
+void Ontology::Locality::conjunction(const ConjunctionConcept *c) {
+    char v = 'T';
+    FOREACH(i, c->elements()) {
+	char w = (*this)(*i);
+	if (w == 'B') {
+	    v = 'B';
+	    break;
+	}
+	if (w == 0)
+	    v = 0;
+    }
+    value = v;
+}
+
+void Ontology::Locality::disjunction(const DisjunctionConcept *c) {
+    char v = 'B';
+    FOREACH(i, c->elements()) {
+	char w = (*this)(*i);
+	if (w == 'T') {
+	    v = 'T';
+	    break;
+	}
+	if (w == 0)
+	    v = 0;
+    }
+    value = v;
+}
+
+void Ontology::Locality::existential(const ExistentialConcept *c) {
+    if (roles.find(c->role()->ID()) == roles.end())
+	value = 'B';
+    else
+	value = ((*this)(c->concept()) == 'B') ? 'B' : 0;
+}
+
+void Ontology::Locality::universal(const UniversalConcept *c) {
+    if (roles.find(c->role()->ID()) == roles.end())
+	value = 'T';
+    else
+	value = ((*this)(c->concept()) == 'T') ? 'T' : 0;
+}
+
+void Ontology::Locality::dummy(const DummyConcept *c) {
+    value = 0;
+}
+
+class Ontology::Signature : public ConceptVisitor {
+  virtual void atomic(const AtomicConcept *c) { concepts.push_back(c->ID()); }
+  virtual void top(const TopConcept *c) {}
+  virtual void bottom(const BottomConcept *c) {}
+  virtual void negation(const NegationConcept *c) { c->concept()->accept(*this); }
+  virtual void conjunction(const ConjunctionConcept *c) { FOREACH(i, c->elements()) (*i)->accept(*this); }
+  virtual void disjunction(const DisjunctionConcept *c) { FOREACH(i, c->elements()) (*i)->accept(*this); }
+  virtual void existential(const ExistentialConcept *c) { roles.push_back(c->role()->ID()); c->concept()->accept(*this); }
+  virtual void universal(const UniversalConcept *c) { roles.push_back(c->role()->ID()); c->concept()->accept(*this); }
+
+  public:
+  vector<ConceptID> concepts;
+  vector<RoleID> roles;
+
+  virtual ~Signature() {}
+};
+
+//restricts the told axioms to the bottom-module for the signature; role axioms are kept
+int Ontology::module(const vector<const Concept*>& signature) {
+    hierarchy.closure();
+
+    vector<pair<const Concept*, const Concept*> > axioms(told_subsumptions);
+    int subsumptions = axioms.size();
+    axioms.insert(axioms.end(), told_disjoints.begin(), told_disjoints.end());
+    int n = axioms.size();
+
+    unordered_multimap<ConceptID, int> concept_occurs;
+    unordered_multimap<RoleID, int> role_occurs;
+    vector<Signature> sig(n);
+    for (int i = 0; i < n; i++) {
+	axioms[i].first->accept(sig[i]);
+	axioms[i].second->accept(sig[i]);
+	FOREACH(c, sig[i].concepts)
+	    concept_occurs.insert(make_pair(*c, i));
+	FOREACH(r, sig[i].roles)
+	    role_occurs.insert(make_pair(*r, i));
+    }
+
+    unordered_set<ConceptID> concepts;
+    unordered_set<RoleID> roles;
+    Locality local(concepts, roles);
+    queue<ConceptID> new_concepts;
+    queue<RoleID> new_roles;
+    vector<bool> in_module(n, false);
+
+    FOREACH(c, signature)
+	if (concepts.insert((*c)->ID()).second)
+	    new_concepts.push((*c)->ID());
+
+    queue<int> check;
+    for (int i = 0; i < n; i++)
+	check.push(i);
+
+    while (!check.empty() || !new_concepts.empty() || !new_roles.empty()) {
+	if (!check.empty()) {
+	    int i = check.front();
+	    check.pop();
+	    if (in_module[i])
+		continue;
+	    bool is_local = (i < subsumptions) ?
+		(local(axioms[i].first) == 'B' || local(axioms[i].second) == 'T') :
+		(local(axioms[i].first) == 'B' || local(axioms[i].second) == 'B');
+	    if (!is_local) {
+		in_module[i] = true;
+		FOREACH(c, sig[i].concepts)
+		    if (concepts.insert(*c).second)
+			new_concepts.push(*c);
+		FOREACH(r, sig[i].roles)
+		    if (roles.find(*r) == roles.end()) {
+			roles.insert(*r);
+			new_roles.push(*r);
+		    }
+	    }
+	}
+	else if (!new_concepts.empty()) {
+	    EQUAL_RANGE(i, concept_occurs, new_concepts.front())
+		if (!in_module[i->second])
+		    check.push(i->second);
+	    new_concepts.pop();
+	}
+	else {
+	    RoleID r = new_roles.front();
+	    new_roles.pop();
+	    //role inclusions r [= s are not local once r is in the signature
+	    for (RoleID s = 1; s < Role::number(); s++)
+		if (hierarchy(r, s) && roles.find(s) == roles.end()) {
+		    roles.insert(s);
+		    new_roles.push(s);
+		}
+	    EQUAL_RANGE(i, role_occurs, r)
+		if (!in_module[i->second])
+		    check.push(i->second);
+	}
+    }
+
+    told_subsumptions.clear();
+    told_disjoints.clear();
+    int m = 0;
+    for (int i = 0; i < n; i++)
+	if (in_module[i]) {
+	    m++;
+	    if (i < subsumptions)
+		told_subsumptions.push_back(axioms[i]);
+	    else
+		told_disjoints.push_back(axioms[i]);
+	}
+    return m;
+}
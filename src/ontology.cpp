@@ -20,8 +20,13 @@
 
 #include "ontology.h"
 #include "factory.h"
+#include "trace.h"
 
 extern Factory factory;
+extern Trace trace;
+
+//measured on ontologies with many disjoint classes
+const int Ontology::clause_cost = 64;
 
 void Ontology::nullary(const Disjunction& a) {
     unary(factory.top()->ID(), a);
@@ -38,9 +43,28 @@ void Ontology::binary(ConceptID c1, ConceptID c2, const Disjunction& a) {
   binary_count[c2]++;
 }
 
+//concepts by their ID, a bit for each
+class ConceptSet {
+  vector<vector<bool> > bits; //by Concept::band() and Concept::serial()
+
+  public:
+  //whether the concept was not in the set before
+  bool insert(ConceptID id) {
+      int b = Concept::band(id), s = Concept::serial(id);
+      if (b >= bits.size())
+	  bits.resize(b + 1);
+      if (s >= bits[b].size())
+	  bits[b].resize(max(s + 1, 2 * (int) bits[b].size()), false);
+      if (bits[b][s])
+	  return false;
+      bits[b][s] = true;
+      return true;
+  }
+};
+
 class Ontology::NegativeStructuralTransformation : public ConceptVisitor {
   Ontology* ontology;
-  unordered_set<ConceptID> seen;
+  ConceptSet seen;
 
   virtual void atomic(const AtomicConcept *c);
   virtual void top(const TopConcept *c);
@@ -62,7 +86,7 @@ class Ontology::NegativeStructuralTransformation : public ConceptVisitor {
 
 class Ontology::PositiveStructuralTransformation : public ConceptVisitor {
   Ontology* ontology;
-  unordered_set<ConceptID> seen; 
+  ConceptSet seen;
 
   virtual void atomic(const AtomicConcept *c);
   virtual void top(const TopConcept *c);
@@ -83,18 +107,10 @@ class Ontology::PositiveStructuralTransformation : public ConceptVisitor {
 };
 
 bool Ontology::NegativeStructuralTransformation::not_seen(const Concept* c) {
-    if (seen.find(c->ID()) == seen.end()) {
-	seen.insert(c->ID());
-	return true;
-    }
-    return false;
+    return seen.insert(c->ID());
 }
 bool Ontology::PositiveStructuralTransformation::not_seen(const Concept* c) {
-    if (seen.find(c->ID()) == seen.end()) {
-	seen.insert(c->ID());
-	return true;
-    }
-    return false;
+    return seen.insert(c->ID());
 }
 
 void Ontology::NegativeStructuralTransformation::atomic(const AtomicConcept *c) {}
@@ -115,13 +131,13 @@ void Ontology::PositiveStructuralTransformation::bottom(const BottomConcept *c)
 void Ontology::NegativeStructuralTransformation::negation(const NegationConcept *c) {
     if (not_seen(c)) {
 	ontology->nullary(Disjunction(c->ID(), Concept::concept_decompose(c->concept())));
-	c->concept()->accept(*positive);
+	ontology->later(c->concept(), positive);
     }
 }
 void Ontology::PositiveStructuralTransformation::negation(const NegationConcept *c) { 
     if (not_seen(c)) {
 	ontology->binary(Concept::concept_decompose(c), c->concept()->ID(), Disjunction());
-	c->concept()->accept(*negative);
+	ontology->later(c->concept(), negative);
     }
 }
 
@@ -136,17 +152,17 @@ void Ontology::NegativeStructuralTransformation::conjunction(const ConjunctionCo
 	    } else if (q[i]->type() == 'N') {
 		const NegationConcept* x = (const NegationConcept*) q[i];
 		s.insert(Concept::concept_decompose(x->concept()));
-		x->concept()->accept(*positive);
+		ontology->later(x->concept(), positive);
 	    }
 	    else if (q[i]->type() == 'U') {
 		const UniversalConcept* y = (const UniversalConcept*) q[i];
 		const ExistentialConcept* x = factory.existential(y->role(), factory.negation(y->concept()));
 		s.insert(Concept::concept_decompose(x));
-		x->accept(*positive);
+		ontology->later(x, positive);
 	    }
 	    else {
 		u.push_back(q[i]);
-		q[i]->accept(*this);
+		ontology->later(q[i], this);
 	    }
 	}
 	s.insert(c->ID());
@@ -173,7 +189,7 @@ void Ontology::PositiveStructuralTransformation::conjunction(const ConjunctionCo
     if (not_seen(c)) 
 	for (vector<const Concept*>::const_iterator i = c->elements().begin(); i != c->elements().end(); i++) {
 	    ontology->unary(Concept::concept_decompose(c), Disjunction(Concept::concept_decompose(*i)));
-	    (*i)->accept(*this);
+	    ontology->later(*i, this);
 	}
 }
 
@@ -181,27 +197,27 @@ void Ontology::NegativeStructuralTransformation::disjunction(const DisjunctionCo
     if (not_seen(c))
 	for (vector<const Concept*>::const_iterator i = c->elements().begin(); i != c->elements().end(); i++) {
 	    ontology->unary((*i)->ID(), Disjunction(c->ID()));
-	    (*i)->accept(*this);
+	    ontology->later(*i, this);
 	}
 }
 void Ontology::PositiveStructuralTransformation::disjunction(const DisjunctionConcept* c) {
     if (not_seen(c)) {
 	ontology->unary(Concept::concept_decompose(c), Disjunction(c->elements(), true));
 	for (vector<const Concept*>::const_iterator i = c->elements().begin(); i != c->elements().end(); i++) 
-	    (*i)->accept(*this);
+	    ontology->later(*i, this);
     }
 }
 
 void Ontology::NegativeStructuralTransformation::existential(const ExistentialConcept *c) {
     if (not_seen(c)) {
 	ontology->negative_existentials.insert(c);
-	c->concept()->accept(*this);
+	ontology->later(c->concept(), this);
     }
 }
 void Ontology::PositiveStructuralTransformation::existential(const ExistentialConcept *c) {
     if (not_seen(c)) {
 	ontology->positive_roles.insert(c->role()->ID());
-	c->concept()->accept(*this);
+	ontology->later(c->concept(), this);
     }
 }
 
@@ -209,36 +225,44 @@ void Ontology::NegativeStructuralTransformation::universal(const UniversalConcep
     if (not_seen(c)) {
 	const ExistentialConcept* e = factory.existential(c->role(), factory.negation(c->concept()));
 	ontology->nullary(Disjunction(c->ID(), Concept::concept_decompose(e)));
-	e->accept(*positive);
+	ontology->later(e, positive);
     }
 }
 
 void Ontology::PositiveStructuralTransformation::universal(const UniversalConcept *c) {
     if (not_seen(c)) {
 	ontology->positive_universals.insert(c);
-	c->concept()->accept(*this); //skip one
+	ontology->later(c->concept(), this); //skip one
     }
 }
 
 void Ontology::subsumption(const Concept* c, const Concept* d) {
+    told_subsumptions.push_back(make_pair(c, d));
+}
+
+void Ontology::disjoint(const Concept* c, const Concept* d) {
+    told_disjoints.push_back(make_pair(c, d));
+}
+
+void Ontology::load_subsumption(const Concept* c, const Concept* d) {
     if (c->type() == 'B' || d->type() == 'T')
 	return;
 
     if (c->type() == 'T' && d->type() == 'U') {
 	const UniversalConcept* u = (const UniversalConcept*) d;
 	role_range.insert(make_pair(u->role()->ID(), Disjunction(Concept::concept_decompose(u->concept()))));
-	u->concept()->accept(*pos_str);
-	c->accept(*neg_str);
+	later(u->concept(), pos_str);
+	later(c, neg_str);
 	return;
     }
-    c->accept(*neg_str);
-    d->accept(*pos_str);
+    later(c, neg_str);
+    later(d, pos_str);
     unary(c->ID(), Disjunction(Concept::concept_decompose(d)));
 }
 
-void Ontology::disjoint(const Concept* c, const Concept* d) {
-    c->accept(*neg_str);
-    d->accept(*neg_str);
+void Ontology::load_disjoint(const Concept* c, const Concept* d) {
+    later(c, neg_str);
+    later(d, neg_str);
     binary(c->ID(), d->ID(), Disjunction());
 }
 
@@ -246,7 +270,7 @@ void Ontology::transitive_role(const Role* r) {
     transitive_roles.insert(r->ID());
 }
 
-Ontology::Ontology() {
+Ontology::Ontology() : redundant(0), split_concepts(0), split_partners(0) {
     pos_str = new PositiveStructuralTransformation(this);
     neg_str = new NegativeStructuralTransformation(this);
     pos_str->negative = neg_str;
@@ -258,10 +282,38 @@ Ontology::~Ontology() {
     delete neg_str;
 }
 
+//the concepts of an axiom are visited from a queue rather than by recursion,
+//so that deeply nested concepts do not exhaust the stack
+void Ontology::later(const Concept* c, ConceptVisitor* v) {
+    pending.push_back(make_pair(c, v));
+}
+
+void Ontology::transform() {
+    while (!pending.empty()) {
+	pair<const Concept*, ConceptVisitor*> p = pending.front();
+	pending.pop_front();
+	p.first->accept(*p.second);
+    }
+}
+
 void Ontology::normalize() {
+    trace.begin("structural transformation");
+    FOREACH(i, told_subsumptions) {
+	load_subsumption(i->first, i->second);
+	transform();
+    }
+    FOREACH(i, told_disjoints) {
+	load_disjoint(i->first, i->second);
+	transform();
+    }
+    trace.end();
+
+    trace.begin("role closure");
     hierarchy.closure();
+    trace.end();
 
     //reduce transitivity for universals
+    trace.begin("transitivity reduction");
     set<const UniversalConcept *> s;   
     FOREACH(u, positive_universals) 
 	FOREACH(i, transitive_roles)
@@ -277,54 +329,347 @@ void Ontology::normalize() {
 	positive_universals.insert(*u);
 	positive_universals.insert((const UniversalConcept *) (*u)->concept());
     }
+    trace.end();
 
     //duals of universals
+    trace.begin("universal duals");
     FOREACH(u, positive_universals) {
 	const ExistentialConcept *e = factory.existential((*u)->role(), factory.negation((*u)->concept()));
 	negative_existentials.insert(e);
 	binary(Concept::concept_decompose(*u), e->ID(), Disjunction());
     }
+    trace.end();
 		    
     //reduce number of neighbours in binary_axioms
-    map<ConceptID, ConceptID> dummy;
-    FOREACH(i, binary_count)
-	if (i->second > 100) {
-	    ConceptID d = factory.dummy(Concept::minimal_ID())->ID();
-	    dummy[i->first] = d;
-	    EQRANGE(j, binary_axioms, i->first)
-		unary(j->second.first, Disjunction(d, j->second.second)); 
-	}
-    FOREACH(i, binary_axioms)
-	if (dummy.find(i->first) != dummy.end() || dummy.find(i->second.first) != dummy.end())
-	    binary_axioms.erase(i);
-    FOREACH(i, dummy) {
-	binary_axioms.insert(make_pair(i->first, make_pair(i->second, Disjunction())));
-	binary_axioms.insert(make_pair(i->second, make_pair(i->first, Disjunction())));
-    }
+    trace.begin("dummy splitting");
+    split();
+    trace.end();
+
+    //the positive roles below every role, in the order of positive_roles
+    vector<vector<RoleID> > positive_sub(Role::number());
+    FOREACH(s, positive_roles)
+	for (RoleID r = 1; r < Role::number(); r++)
+	    if (hierarchy(*s, r))
+		positive_sub[r].push_back(*s);
 
     //unfold role hierarchy into existential axioms
+    trace.begin("role unfolding");
     FOREACH(e, negative_existentials)
-	FOREACH(r, positive_roles)
-	    if (hierarchy(*r, (*e)->role()->ID())) 
-		universal_axioms.insert(make_pair(make_pair((*e)->concept()->ID(), *r), (*e)->ID()));
+	FOREACH(r, positive_sub[(*e)->role()->ID()])
+	    universal_axioms.insert(make_pair(make_pair((*e)->concept()->ID(), *r), (*e)->ID()));
+    trace.end();
 		
     //reduce transitivity for existentials
+    trace.begin("existential transitivity");
     FOREACH(e, negative_existentials) {
 	RoleID r = (*e)->role()->ID();
 	if (transitive_roles.find(r) != transitive_roles.end()) 
-	    FOREACH(s, positive_roles)
-		if (hierarchy(*s, r))
-		    universal_axioms.insert(make_pair(make_pair((*e)->ID(), *s), (*e)->ID()));
+	    FOREACH(s, positive_sub[r])
+		universal_axioms.insert(make_pair(make_pair((*e)->ID(), *s), (*e)->ID()));
 
 	FOREACH(t, transitive_roles)
 	    if (*t != r && hierarchy(*t, r)) {
 		ConceptID f = factory.existential(factory.role(*t), (*e)->concept())->ID();
-		FOREACH(s, positive_roles)
-		    if (hierarchy(*s, *t)) {
-			universal_axioms.insert(make_pair(make_pair((*e)->concept()->ID(), *s), f));
-			universal_axioms.insert(make_pair(make_pair(f, *s), f));
-			universal_axioms.insert(make_pair(make_pair(f, *s), (*e)->ID()));
-		    }
+		FOREACH(s, positive_sub[*t]) {
+		    universal_axioms.insert(make_pair(make_pair((*e)->concept()->ID(), *s), f));
+		    universal_axioms.insert(make_pair(make_pair(f, *s), f));
+		    universal_axioms.insert(make_pair(make_pair(f, *s), (*e)->ID()));
+		}
+	    }
+    }
+    trace.end();
+
+    trace.begin("redundant axioms");
+    redundant = reduce();
+    trace.end();
+
+    //axioms are only read from now on
+    FOREACH(i, unary_axioms)
+	i->second.freeze();
+    FOREACH(i, binary_axioms)
+	i->second.second.freeze();
+    FOREACH(i, role_range)
+	i->second.freeze();
+
+    //so that a new context only looks at the ranges of its incoming role
+    role_ranges.assign(Role::number(), vector<Disjunction>());
+    for (RoleID r = 1; r < Role::number(); r++)
+	FOREACH(i, role_range)
+	    if (hierarchy(r, i->first))
+		role_ranges[r].push_back(i->second);
+}
+
+//The number of concepts below c through the unary axioms with a single
+//literal, counting c, as an estimate of the number of contexts c is derived
+//in. Concepts below by several paths count more than once, those on a cycle
+//with c not at all, and the estimate is at most the limit.
+static double below(ConceptID c, const unordered_map<ConceptID, vector<ConceptID> >& sub,
+	unordered_map<ConceptID, double>& count, double limit) {
+    unordered_map<ConceptID, double>::iterator m = count.find(c);
+    if (m != count.end())
+	return m->second;
+    count[c] = 0;
+    vector<pair<ConceptID, int> > call(1, make_pair(c, 0)); //without recursion, as in told.cpp
+    while (!call.empty()) {
+	ConceptID v = call.back().first;
+	unordered_map<ConceptID, vector<ConceptID> >::const_iterator s = sub.find(v);
+	if (s != sub.end() && call.back().second < s->second.size()) {
+	    ConceptID w = s->second[call.back().second++];
+	    if (count.find(w) == count.end()) {
+		count[w] = 0;
+		call.push_back(make_pair(w, 0));
+	    }
+	    continue;
+	}
+	double n = 1;
+	if (s != sub.end())
+	    FOREACH(w, s->second)
+		n += count[*w];
+	count[v] = min(n, limit);
+	call.pop_back();
+    }
+    return count[c];
+}
+
+//With a binary axiom c x -> D, every context where c is derived looks up x.
+//If x is derived in much fewer contexts than c, the axiom is replaced by
+//x -> d v D with a new concept d, one for all such x, and c d -> bottom:
+//then c looks up only d, but every context of x gets the clause d v D. The
+//number of contexts of a concept is estimated by below(), a new clause costs
+//as much as clause_cost lookups, and c is split if the lookups saved by the
+//x chosen pay for the one of d.
+void Ontology::split() {
+    unordered_map<ConceptID, vector<ConceptID> > sub;
+    FOREACH(i, unary_axioms)
+	if (i->second.size() == 1)
+	    sub[Concept::clear_decompose(i->second.front())].push_back(Concept::clear_decompose(i->first));
+    unordered_map<ConceptID, double> count;
+    double limit = unary_axioms.size() + 1;
+
+    set<pair<ConceptID, ConceptID> > moved; //both ways
+    vector<pair<ConceptID, ConceptID> > dummy; //of the concepts split
+    FOREACH(i, binary_count) {
+	double c = below(Concept::clear_decompose(i->first), sub, count, limit);
+	if (c <= clause_cost)
+	    continue;
+	double saved = 0;
+	set<ConceptID> chosen;
+	EQRANGE(j, binary_axioms, i->first) {
+	    double x = below(Concept::clear_decompose(j->second.first), sub, count, limit);
+	    if (c > clause_cost * x) {
+		saved += c - clause_cost * x;
+		chosen.insert(j->second.first);
 	    }
+	}
+	if (saved <= c)
+	    continue;
+	ConceptID d = factory.dummy(Concept::minimal_ID())->ID();
+	dummy.push_back(make_pair(i->first, d));
+	FOREACH(x, chosen) {
+	    moved.insert(make_pair(i->first, *x));
+	    moved.insert(make_pair(*x, i->first));
+	}
+	//not the axioms moved when x was split, c would get the clauses then
+	EQRANGE(j, binary_axioms, i->first)
+	    if (chosen.find(j->second.first) != chosen.end())
+		unary(j->second.first, Disjunction(d, j->second.second));
+	split_partners += chosen.size();
+    }
+
+    for (__typeof(binary_axioms.begin()) i = binary_axioms.begin(); i != binary_axioms.end(); )
+	if (moved.find(make_pair(i->first, i->second.first)) != moved.end())
+	    i = binary_axioms.erase(i);
+	else
+	    i++;
+    FOREACH(i, dummy) {
+	binary_axioms.insert(make_pair(i->first, make_pair(i->second, Disjunction())));
+	binary_axioms.insert(make_pair(i->second, make_pair(i->first, Disjunction())));
+    }
+    split_concepts = dummy.size();
+}
+
+//whether every literal of a is in b, with the same flags; the literals of
+//both are in the order of Concept::DecomposeLess
+static bool contained(const Disjunction& a, const Disjunction& b) {
+    ConceptID* j = b.begin();
+    FOREACH(i, a) {
+	while (j != b.end() && *j != *i)
+	    j++;
+	if (j == b.end())
+	    return false;
+	j++;
+    }
+    return true;
+}
+
+//the positions of the clauses that repeat or contain another one of the
+//given, keeping the first of the equal ones
+static vector<int> subsumed(const vector<Disjunction>& v) {
+    vector<pair<int, int> > order; //by size, then position
+    for (int i = 0; i < v.size(); i++)
+	order.push_back(make_pair(v[i].size(), i));
+    sort(order.begin(), order.end());
+
+    vector<int> r;
+    bool empty = false;
+    unordered_map<ConceptID, vector<int> > kept; //by the first literal
+    FOREACH(o, order) {
+	const Disjunction& d = v[o->second];
+	bool found = empty;
+	for (ConceptID* l = d.begin(); l != d.end() && !found; l++) {
+	    unordered_map<ConceptID, vector<int> >::iterator k = kept.find(*l);
+	    if (k != kept.end())
+		FOREACH(j, k->second)
+		    if (contained(v[*j], d)) {
+			found = true;
+			break;
+		    }
+	}
+	if (found)
+	    r.push_back(o->second);
+	else if (d.size() == 0)
+	    empty = true;
+	else
+	    kept[d.front()].push_back(o->second);
+    }
+    return r;
+}
+
+//Drops the unary axioms on a concept that repeat or contain another one on
+//it, and the same for the binary axioms on a pair of concepts. They derive
+//only clauses that contain one derived by the axiom kept. The others stay in
+//their order. Returns the number of axioms dropped.
+int Ontology::reduce() {
+    int r = 0;
+    __typeof(unary_axioms.begin()) i = unary_axioms.begin();
+    while (i != unary_axioms.end()) {
+	pair<__typeof(i), __typeof(i)> range = unary_axioms.equal_range(i->first);
+	i = range.second;
+	vector<__typeof(i)> at;
+	vector<Disjunction> v;
+	for (__typeof(i) j = range.first; j != range.second; j++) {
+	    at.push_back(j);
+	    v.push_back(j->second);
+	}
+	vector<int> s = subsumed(v);
+	FOREACH(j, s)
+	    unary_axioms.erase(at[*j]);
+	r += s.size();
+    }
+
+    __typeof(binary_axioms.begin()) b = binary_axioms.begin();
+    while (b != binary_axioms.end()) {
+	pair<__typeof(b), __typeof(b)> range = binary_axioms.equal_range(b->first);
+	b = range.second;
+	map<ConceptID, vector<__typeof(b)> > at; //by the other concept
+	for (__typeof(b) j = range.first; j != range.second; j++)
+	    at[j->second.first].push_back(j);
+	FOREACH(k, at) {
+	    vector<Disjunction> v;
+	    FOREACH(j, k->second)
+		v.push_back((*j)->second.second);
+	    vector<int> s = subsumed(v);
+	    FOREACH(j, s)
+		binary_axioms.erase(k->second[*j]);
+	    r += s.size();
+	}
+    }
+    return r;
+}
+
+//The dispatch records of the concepts in the axioms, once no more axioms
+//come, taking the axioms on each concept from a single pass over them. The
+//records of other concepts are compiled when they are first looked up.
+void Ontology::compile() {
+    FOREACH(i, unary_axioms) {
+	record(i->first).unary[Concept::decompose(i->first)] = true;
+	FOREACH(j, i->second)
+	    record(*j);
+    }
+    FOREACH(i, binary_axioms) {
+	record(i->first).binary[Concept::decompose(i->first)] = true;
+	FOREACH(j, i->second.second)
+	    record(*j);
+    }
+    FOREACH(i, universal_axioms) {
+	record(i->first.first).universal = true;
+	record(i->second);
+    }
+    FOREACH(i, role_range)
+	FOREACH(j, i->second)
+	    record(*j);
+}
+
+//the record of a concept in the axioms, with room made for it
+Dispatch& Ontology::record(ConceptID id) {
+    id = Concept::normalize(id);
+    int b = Concept::band(id), s = Concept::serial(id);
+    if (b >= dispatch_table.size())
+	dispatch_table.resize(b + 1);
+    if (s >= dispatch_table[b].size())
+	dispatch_table[b].resize(max(s + 1, 2 * (int) dispatch_table[b].size()));
+    Dispatch& d = dispatch_table[b][s];
+    if (!d.concept)
+	describe(id, d);
+    return d;
+}
+
+Dispatch& Ontology::compile(ConceptID id, Dispatch& d) {
+    describe(id, d);
+    for (int k = 0; k < 2; k++) {
+	ConceptID x = k ? Concept::mark_decompose(id) : id;
+	d.unary[k] = unary_axioms.find(x) != unary_axioms.end();
+	d.binary[k] = binary_axioms.find(x) != binary_axioms.end();
+    }
+    __typeof(universal_axioms.begin()) u = universal_axioms.lower_bound(make_pair(id, 0));
+    d.universal = u != universal_axioms.end() && u->first.first == id;
+    return d;
+}
+
+//all but the axioms on the concept
+void Ontology::describe(ConceptID id, Dispatch& d) {
+    d.concept = factory.concept(id);
+    d.type = d.concept->type();
+    d.unary[0] = d.unary[1] = d.binary[0] = d.binary[1] = d.universal = false;
+    if (d.type == 'E') {
+	const ExistentialConcept* e = (const ExistentialConcept*) d.concept;
+	d.role = e->role()->ID();
+	d.filler = e->concept();
+    }
+    if (d.type == 'U') {
+	const UniversalConcept* u = (const UniversalConcept*) d.concept;
+	d.role = u->role()->ID();
+	d.filler = u->concept();
+	d.successor = Disjunction(Concept::concept_decompose(d.filler), Concept::annotate(factory.negation(d.filler)->ID()));
+	d.successor.freeze();
+    }
+}
+
+//every clause derivable from the normalized axioms has a single literal,
+//or a literal guarded by a dummy that splits binary axioms with many partners;
+//the partners of a guard are not guards, so two guarded clauses never meet
+bool Ontology::horn() const {
+    if (!positive_universals.empty())
+	return false;
+    FOREACH(i, role_range)
+	if (i->second.size() > 1)
+	    return false;
+    FOREACH(i, binary_axioms)
+	if (i->second.second.size() > 1 || (i->second.second.size() == 1 && factory.concept(i->first)->type() == 'X'))
+	    return false;
+    FOREACH(i, unary_axioms) {
+	if (Concept::decompose(i->first) && factory.concept(i->first)->type() == 'D')
+	    return false;
+	if (i->second.size() > 2)
+	    return false;
+	if (i->second.size() == 2) {
+	    ConceptID guard = i->second.front();
+	    if (factory.concept(guard)->type() != 'X' || factory.concept(i->second.back())->type() == 'X' || unary_axioms.find(guard) != unary_axioms.end())
+		return false;
+	    EQRANGE(j, binary_axioms, guard)
+		if (factory.concept(j->second.first)->type() == 'X')
+		    return false;
+	}
     }
+    return true;
 }
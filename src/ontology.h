@@ -20,18 +20,35 @@
 #define ONTOLOGY_H_
 
 #include <list>
+#include <deque>
+#include <vector>
 #include <algorithm>
 #include <set>
 #include <map>
 
 #include "header.h"
 #include "tracker.h"
+#include "memory.h"
 #include "role.h"
 #include "concept.h"
 #include "disjunction.h"
 
 using namespace std;
 
+// What the rules need to know about a concept, so that a derived clause costs
+// one lookup by the ID of its head: the type, the parts of an existential or
+// a universal and which axioms there are on the ID.
+struct Dispatch {
+  const Concept* concept; // NULL until compiled
+  char type;
+  bool unary[2], binary[2]; // axioms on the ID, without and with the decompose flag
+  bool universal; // universal axioms on the ID for some role
+  RoleID role; // of an existential or a universal
+  const Concept* filler;
+  Disjunction successor; // of a universal, what it gives to the successors
+
+  Dispatch() : concept(NULL), successor(Disjunction::bottom) {}
+};
 
 class Ontology {
 
@@ -41,20 +58,51 @@ class Ontology {
     NegativeStructuralTransformation* neg_str;
     PositiveStructuralTransformation* pos_str;
 
+    class Locality;
+    class Signature;
+
+    void load_subsumption(const Concept*, const Concept*);
+    void load_disjoint(const Concept*, const Concept*);
+
+    deque<pair<const Concept*, ConceptVisitor*> > pending; // of the structural transformation
+    void later(const Concept* c, ConceptVisitor* v);
+    void transform();
+
+    typedef vector<Dispatch, CountingAllocator<Dispatch, Memory::ONTOLOGY> > Band;
+    vector<Band> dispatch_table; // by Concept::band() and Concept::serial()
+    map<ConceptID, Dispatch> dispatch_rest; // of concepts made after compile()
+    void split();
+    int reduce();
+
+    Dispatch& compile(ConceptID id, Dispatch& d);
+    Dispatch& record(ConceptID id);
+    void describe(ConceptID id, Dispatch& d);
+
 public:
 
   RoleHierarchy hierarchy;
 
-  unordered_multimap<ConceptID, Disjunction> unary_axioms;
-  unordered_multimap<ConceptID, pair<ConceptID, Disjunction> > binary_axioms;
+  // axioms as read by the parser, transformed only in normalize()
+  vector<pair<const Concept*, const Concept*> > told_subsumptions;
+  vector<pair<const Concept*, const Concept*> > told_disjoints;
+
+  unordered_multimap<ConceptID, Disjunction, std::tr1::hash<ConceptID>, equal_to<ConceptID>,
+      CountingAllocator<pair<const ConceptID, Disjunction>, Memory::ONTOLOGY> > unary_axioms;
+  unordered_multimap<ConceptID, pair<ConceptID, Disjunction>, std::tr1::hash<ConceptID>, equal_to<ConceptID>,
+      CountingAllocator<pair<const ConceptID, pair<ConceptID, Disjunction> >, Memory::ONTOLOGY> > binary_axioms;
   map<ConceptID, int> binary_count;
 
   set<const ExistentialConcept*> negative_existentials;
   set<const UniversalConcept*> positive_universals;
-  multimap<pair<ConceptID, RoleID>, ConceptID> universal_axioms;  // could try hash_map instead
+  multimap<pair<ConceptID, RoleID>, ConceptID, less<pair<ConceptID, RoleID> >,
+      CountingAllocator<pair<const pair<ConceptID, RoleID>, ConceptID>, Memory::ONTOLOGY> > universal_axioms;  // could try hash_map instead
   set<RoleID> positive_roles;
   set<pair<RoleID, Disjunction> > role_range;
+  vector<vector<Disjunction> > role_ranges; // by role, with the ranges of its super-roles; set by normalize()
   set<RoleID> transitive_roles;
+  int redundant; // axioms dropped by normalize() as repeating or containing others
+  int split_concepts, split_partners; // concepts whose binary axioms normalize() split, and the others moved to their dummies
+  static const int clause_cost; // of a new clause in lookups of binary axioms, for the splitting
 
   void nullary(const Disjunction& a);
   void unary(ConceptID c, const Disjunction& a);
@@ -66,7 +114,23 @@ public:
 
   Ontology();
   ~Ontology();
+    int module(const vector<const Concept*>& signature);
     void normalize();
+    void compile();
+    bool horn() const;
+
+    const Dispatch& dispatch(ConceptID id);
 };
 
+inline const Dispatch& Ontology::dispatch(ConceptID id) {
+    id = Concept::normalize(id);
+    int b = Concept::band(id), s = Concept::serial(id);
+    if (b < dispatch_table.size() && s < dispatch_table[b].size()) {
+	Dispatch& d = dispatch_table[b][s];
+	return d.concept ? d : compile(id, d);
+    }
+    Dispatch& d = dispatch_rest[id];
+    return d.concept ? d : compile(id, d);
+}
+
 #endif /* ONTOLOGY_H_ */
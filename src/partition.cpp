@@ -0,0 +1,116 @@
+/*
+ * Copyright (c) 2010 Frantisek Simancik
+ * <frantisek.simancik@comlab.ox.ac.uk>, Yevgeny Kazakov
+ * <yevgeny.kazakov@comlab.ox.ac.uk> and University of Oxford
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <algorithm>
+
+#include "partition.h"
+
+ConceptID Partition::find(ConceptID c) {
+    c = Concept::normalize(c);
+    unordered_map<ConceptID, ConceptID>::iterator i = parent.find(c);
+    if (i == parent.end())
+	return c;
+    ConceptID r = find(i->second);
+    i->second = r;
+    return r;
+}
+
+void Partition::join(ConceptID c, ConceptID d) {
+    if (Concept::normalize(c) == top || Concept::normalize(c) == bottom || Concept::normalize(d) == top || Concept::normalize(d) == bottom)
+	return;
+    c = find(c);
+    d = find(d);
+    if (c != d)
+	parent[c] = d;
+}
+
+void Partition::join(ConceptID c, const Disjunction& d) {
+    FOREACH(x, d)
+	join(c, *x);
+}
+
+Partition::Partition(const Ontology& ontology, Factory& factory) : top(factory.top()->ID()), bottom(factory.bottom()->ID()) {
+    set<ConceptID> heads;
+    FOREACH(i, ontology.unary_axioms) {
+	heads.insert(Concept::normalize(i->first));
+	FOREACH(x, i->second)
+	    heads.insert(Concept::normalize(*x));
+	join(i->first, i->second);
+    }
+    FOREACH(i, ontology.binary_axioms) {
+	join(i->first, i->second.first);
+	join(i->first, i->second.second);
+	FOREACH(x, i->second.second)
+	    heads.insert(Concept::normalize(*x));
+    }
+    FOREACH(i, ontology.universal_axioms)
+	join(i->first.first, i->second);
+
+    //existentials link to their fillers, universals derive their fillers
+    FOREACH(c, heads) {
+	const Concept* x = factory.concept(*c);
+	if (x->type() == 'E')
+	    join(*c, ((const ExistentialConcept*) x)->concept()->ID());
+	if (x->type() == 'U') {
+	    const UniversalConcept* u = (const UniversalConcept*) x;
+	    join(*c, u->concept()->ID());
+	    join(*c, factory.negation(u->concept())->ID());
+	}
+    }
+}
+
+//goals grouped by component, the largest first
+vector<vector<const Concept*> > Partition::components(const vector<const Concept*>& goals) {
+    unordered_map<ConceptID, int> index;
+    vector<vector<const Concept*> > r;
+    FOREACH(g, goals) {
+	ConceptID c = find((*g)->ID());
+	if (index.find(c) == index.end()) {
+	    index[c] = r.size();
+	    r.push_back(vector<const Concept*>());
+	}
+	r[index[c]].push_back(*g);
+    }
+    stable_sort(r.begin(), r.end(), SizeGreater());
+    return r;
+}
+
+//components larger than an even share are cut into slices of consecutive goals,
+//then every piece is assigned to the least loaded of n jobs
+vector<vector<const Concept*> > Partition::jobs(const vector<vector<const Concept*> >& components, int n) {
+    int total = 0;
+    FOREACH(i, components)
+	total += i->size();
+    int share = (total + n - 1) / n;
+
+    vector<vector<const Concept*> > pieces;
+    FOREACH(i, components)
+	for (int b = 0; b < i->size(); b += share)
+	    pieces.push_back(vector<const Concept*>(i->begin() + b, i->begin() + min(b + share, (int) i->size())));
+    stable_sort(pieces.begin(), pieces.end(), SizeGreater());
+
+    vector<vector<const Concept*> > r(min(n, (int) pieces.size()));
+    FOREACH(i, pieces) {
+	int k = 0;
+	for (int j = 1; j < r.size(); j++)
+	    if (r[j].size() < r[k].size())
+		k = j;
+	r[k].insert(r[k].end(), i->begin(), i->end());
+    }
+    return r;
+}
@@ -0,0 +1,55 @@
+/*
+ * Copyright (c) 2010 Frantisek Simancik
+ * <frantisek.simancik@comlab.ox.ac.uk>, Yevgeny Kazakov
+ * <yevgeny.kazakov@comlab.ox.ac.uk> and University of Oxford
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef PARTITION_H_
+#define PARTITION_H_
+
+#include <vector>
+
+#include "header.h"
+#include "concept.h"
+#include "disjunction.h"
+#include "factory.h"
+#include "ontology.h"
+
+using namespace std;
+
+// Connected components of the normalized axioms. owl:Thing, owl:Nothing
+// and role ranges occur in every context, so they do not connect anything.
+class Partition {
+  unordered_map<ConceptID, ConceptID> parent;
+  ConceptID top, bottom;
+
+  ConceptID find(ConceptID c);
+  void join(ConceptID c, ConceptID d);
+  void join(ConceptID c, const Disjunction& d);
+
+  struct SizeGreater {
+      bool operator()(const vector<const Concept*>& a, const vector<const Concept*>& b) const {
+	  return a.size() > b.size();
+      }
+  };
+
+  public:
+  Partition(const Ontology& ontology, Factory& factory);
+
+  vector<vector<const Concept*> > components(const vector<const Concept*>& goals);
+  static vector<vector<const Concept*> > jobs(const vector<vector<const Concept*> >& components, int n);
+};
+
+#endif /* PARTITION_H_ */
@@ -28,6 +28,10 @@
 #include <queue>
 #include <algorithm>
 #include <time.h>
+#include <cstdlib>
+#include <unistd.h>
+#include <poll.h>
+#include <sys/wait.h>
 
 #include "header.h"
 #include "tracker.h"
@@ -38,10 +42,19 @@
 #include "ontology.h"
 #include "parser.h"
 #include "formatter.h"
+#include "partition.h"
+#include "told.h"
+#include "taxonomy.h"
+#include "stats.h"
+#include "trace.h"
+#include "memory.h"
+#include "store.h"
 
 using namespace std;
 
 bool PRINT_LOG = false;
+bool PROFILE = false;
+bool HOT = false;
 bool VERBOSE = false;
 bool OUTPUT = true;
 
@@ -49,19 +62,35 @@ bool SUBSET_OPT = true;
 bool REMOVE_OPT = false;
 bool TOP_PRESENT, TOP_OPT = false;
 bool SECONDARY_OPT = false;
+bool MODULE_OPT = true;
+bool TOLD_OPT = true;
+bool HORN_OPT = true;
+bool HORN = false;
+bool UNLINK = true; //contexts unlink from their neighbours when destroyed
 
 int goals_set = 0;
+int WORKERS = 1;
+long long MEMORY_LIMIT = 0; //in bytes, none if 0
+
+enum Schedule { FIFO, LIFO, SMALLEST, ROLE, GOAL, SCHEDULES };
+const char* schedule_names[SCHEDULES] = { "fifo", "lifo", "smallest", "role", "goal" };
+Schedule SCHEDULE = FIFO;
+Formatter::Format FORMAT = Formatter::OWL;
+
+string write_literal(ConceptID x) {
+    string s = factory.concept(x)->to_string();
+    if (Concept::decompose(x))
+	s += "+";
+    if (Concept::is_annotated(x))
+	s += "*";
+    return s;
+}
 
-string write_disjunction(const Disjunction& d) {
+template<typename D>
+string write_disjunction(const D& d) {
     stringstream ss;
-    FOREACH(x, d) {
-	const Concept* c = factory.concept(*x);
-	ss << " " << c->to_string();
-	if (Concept::decompose(*x))
-	    ss << "+";
-	if (Concept::is_annotated(*x))
-	    ss << "*";
-    }
+    FOREACH(x, d)
+	ss << " " << write_literal(*x);
     return ss.str();
 }
 
@@ -69,6 +98,10 @@ int time_interval(long long a, long long b) {
     return (b-a)*1000 / CLOCKS_PER_SEC;
 }
 
+double average(double total, int n) {
+    return n ? total / n : 0;
+}
+
 int context_init_number = 0;
 int axiom_init_number = 0;
 int max_init_axioms = 0;
@@ -91,23 +124,275 @@ int max_topush = 0;
 Factory factory;
 Ontology ontology;
 Formatter formatter;
+ToldHierarchy* told = NULL;
+Statistics statistics;
+Trace trace;
+Store store;
+
+//contexts are found by their role and the ID of their core
+struct ContextHash {
+    size_t operator()(const pair<RoleID, const Concept*>& x) const {
+	return (size_t) x.second->ID() * 31 + x.first;
+    }
+};
+
+//Successor contexts with their clauses in memory, in the order they came
+//into memory. When the memory of contexts and clauses exceeds the limit
+//(the factory and the ontology aside, which cannot be moved), the cold
+//ones are written to the store from the front down to three quarters of
+//the limit; those used since they were passed last get another round (the
+//clock algorithm). If the rest does not fit, the next round waits until the memory grows by
+//another quarter of the limit, so that contexts are not moved back and
+//forth after every saturation.
+template<typename C>
+class Residents {
+    deque<C*> queue;
+    long long threshold;
+
+    public:
+    Residents() : threshold(0) {}
+
+    static long long bytes() {
+	return Memory::bytes(Memory::CONTEXTS) + Memory::bytes(Memory::DISJUNCTIONS);
+    }
+
+    void add(C* c) {
+	if (MEMORY_LIMIT)
+	    queue.push_back(c);
+    }
+
+    void evict() {
+	if (bytes() <= max(threshold, MEMORY_LIMIT))
+	    return;
+	for (int n = queue.size(); n > 0 && bytes() > MEMORY_LIMIT / 4 * 3; n--) {
+	    C* c = queue.front();
+	    queue.pop_front();
+	    if (!c->satisfiable)
+		continue;
+	    if (c->referenced || !c->cold()) {
+		c->referenced = false;
+		queue.push_back(c);
+	    }
+	    else
+		c->unload();
+	}
+	threshold = bytes() + MEMORY_LIMIT / 4;
+    }
+
+    void clear() {
+	queue.clear();
+    }
+};
+
+//Active contexts, in the order given by SCHEDULE:
+//  FIFO      as they became active;
+//  LIFO      the last to become active first;
+//  SMALLEST  the one with the fewest clauses to process first;
+//  ROLE      all contexts of an incoming role, then those of the next one;
+//  GOAL      the goal context whenever it has clauses, the others as FIFO.
+//Contexts with the core owl:Thing always come first. A context can be in
+//more than once, processing it again does nothing.
+template<typename C>
+class Scheduler {
+    deque<C*> first, queue;
+    typedef pair<pair<int, long long>, C*> Entry; //by the clauses to process, then the arrival
+    priority_queue<Entry, vector<Entry>, greater<Entry> > smallest;
+    vector<deque<C*> > roles;
+    int role, n;
+    long long arrival;
+
+    public:
+    Scheduler() : role(0), n(0), arrival(0) {}
+
+    bool empty() const {
+	return n == 0;
+    }
+
+    void push(C* c) {
+	n++;
+	if (c->top || (SCHEDULE == GOAL && c->inrole == 0))
+	    first.push_front(c);
+	else if (SCHEDULE == SMALLEST)
+	    smallest.push(make_pair(make_pair(c->pending(), arrival++), c));
+	else if (SCHEDULE == ROLE) {
+	    if (c->inrole >= roles.size())
+		roles.resize(c->inrole + 1);
+	    roles[c->inrole].push_back(c);
+	}
+	else
+	    queue.push_back(c);
+    }
+
+    C* pop() {
+	n--;
+	C* c;
+	if (!first.empty()) {
+	    c = first.front();
+	    first.pop_front();
+	}
+	else if (SCHEDULE == SMALLEST) {
+	    //the clauses to process may have grown since
+	    while (smallest.top().first.first != smallest.top().second->pending()) {
+		Entry e = smallest.top();
+		smallest.pop();
+		e.first.first = e.second->pending();
+		smallest.push(e);
+	    }
+	    c = smallest.top().second;
+	    smallest.pop();
+	}
+	else if (SCHEDULE == ROLE) {
+	    while (roles[role].empty())
+		role = (role + 1) % roles.size();
+	    c = roles[role].front();
+	    roles[role].pop_front();
+	}
+	else if (SCHEDULE == LIFO) {
+	    c = queue.back();
+	    queue.pop_back();
+	}
+	else {
+	    c = queue.front();
+	    queue.pop_front();
+	}
+	return c;
+    }
+};
+
+//A clause of a Horn ontology (Ontology::horn): empty, a single literal, or a
+//literal guarded by a dummy that splits binary axioms. It is kept by value in
+//place of a Disjunction, so contexts of Horn ontologies allocate no clauses.
+//The literals are ordered as in a Disjunction, so the guard comes first.
+class HornClause {
+    ConceptID t[2];
+    int n;
+
+    void insert(ConceptID c) {
+	ConceptID k = Concept::clear_decompose(c);
+	for (int i = 0; i < n; i++)
+	    if (Concept::clear_decompose(t[i]) == k)
+		return;
+	if (n == 2)
+	    cerr << "Internal error: not a Horn clause" << endl;
+	else if (n == 1 && k < Concept::clear_decompose(t[0])) {
+	    t[1] = t[0];
+	    t[0] = c;
+	    n++;
+	}
+	else
+	    t[n++] = c;
+    }
+
+    public:
+    HornClause() : n(0) {}
+    explicit HornClause(ConceptID c) : n(1) { t[0] = c; }
+    HornClause(ConceptID c, ConceptID d) : n(0) { insert(c); insert(d); }
+    explicit HornClause(const Disjunction& d) : n(0) {
+	FOREACH(i, d)
+	    insert(*i);
+    }
+    explicit HornClause(const set<ConceptID, Concept::DecomposeLess>& s) : n(0) {
+	FOREACH(i, s)
+	    insert(*i);
+    }
+    HornClause(const ConceptID* b, const ConceptID* e) : n(e - b) { copy(b, e, t); }
+
+    const ConceptID* begin() const { return t; }
+    const ConceptID* end() const { return t + n; }
+    int size() const { return n; }
+    ConceptID operator[](int i) const { return t[i]; }
+    ConceptID front() const { return t[0]; }
+    ConceptID back() const { return t[n - 1]; }
+
+    bool operator==(const HornClause& rhs) const {
+	if (n != rhs.n)
+	    return false;
+	for (int i = 0; i < n; i++)
+	    if (Concept::clear_decompose(t[i]) != Concept::clear_decompose(rhs.t[i]))
+		return false;
+	return true;
+    }
+
+    bool operator<(const HornClause& rhs) const {
+	if (n != rhs.n)
+	    return n < rhs.n;
+	for (int i = 0; i < n; i++)
+	    if (Concept::clear_decompose(t[i]) != Concept::clear_decompose(rhs.t[i]))
+		return Concept::clear_decompose(t[i]) < Concept::clear_decompose(rhs.t[i]);
+	return false;
+    }
+
+    bool subset(const HornClause& rhs) const {
+	for (int i = 0; i < n; i++)
+	    if (Concept::clear_decompose(t[i]) != Concept::clear_decompose(rhs.t[0]) && (rhs.n < 2 || Concept::clear_decompose(t[i]) != Concept::clear_decompose(rhs.t[1])))
+		return false;
+	return true;
+    }
+
+    //this with the literals of a but the first, as Disjunction::resolve
+    HornClause resolve(const HornClause& a) const {
+	HornClause d(*this);
+	for (int i = 1; i < a.n; i++)
+	    d.insert(a.t[i]);
+	return d;
+    }
+
+    HornClause resolve(const HornClause& a1, const HornClause& a2) const {
+	return resolve(a1).resolve(a2);
+    }
+
+    HornClause annotate() const {
+	return HornClause(Concept::annotate(Concept::normalize(front()))).resolve(*this);
+    }
+
+    struct SizeLess {
+	bool operator()(const HornClause& a, const HornClause& b) const {
+	    return a.n < b.n;
+	}
+    };
+};
 
+//the conclusion of an axiom resolved with clauses of a context
+template<typename D>
+D resolve(const Disjunction& conclusion, const D& a) {
+    return D(conclusion).resolve(a);
+}
+
+template<typename D>
+D resolve(const Disjunction& conclusion, const D& a1, const D& a2) {
+    return D(conclusion).resolve(a1, a2);
+}
+
+inline Disjunction resolve(const Disjunction& conclusion, const Disjunction& a) {
+    return conclusion.resolve(a);
+}
+
+inline Disjunction resolve(const Disjunction& conclusion, const Disjunction& a1, const Disjunction& a2) {
+    return conclusion.resolve(a1, a2);
+}
+
+template<typename D>
 class Pusher {
-    vector<pair<map<pair<ConceptID, RoleID>, ConceptID>::iterator, map<pair<ConceptID, RoleID>, ConceptID>::iterator> > bounds; 
-    vector<map<pair<ConceptID, RoleID>, ConceptID>::iterator> v;
+    typedef __typeof(ontology.universal_axioms.begin()) Iterator;
+    vector<pair<Iterator, Iterator> > bounds; 
+    vector<Iterator> v;
     int n, i;
-    Disjunction d;
+    D d;
 
     void build() {
+	if (n == 1) {
+	    d = D(v[0]->second);
+	    return;
+	}
 	set<ConceptID, Concept::DecomposeLess> s;
 	for (int j = 0; j < n; j++)
 	    s.insert(v[j]->second);
-	d = Disjunction(s);
+	d = D(s);
     }
 
     public:
 
-    Pusher(const Disjunction& ax, RoleID r, int nn = -1) {
+    Pusher(const D& ax, RoleID r, int nn = -1) {
 	if (nn == -1)
 	    n = ax.size();
 	else
@@ -149,17 +434,31 @@ class Pusher {
 	    return false;
     }
 
-    Disjunction disjunction() {
+    D disjunction() {
 	return d;
     }
 };
 
 ConceptID split_ID[2];
 
+//options of the inference rules fixed at compile time for a specialized
+//Context::process, so that the rule application loop does not test the global
+//flags for every clause; VERBOSE and PROFILE only add output and stay tested
+template<bool SUBSET, bool REMOVE, bool TOP, bool SECONDARY, bool SUCCESSOR, bool TOP_CORE>
+struct Policy {
+    static const bool subset = SUBSET;
+    static const bool remove = REMOVE;
+    static const bool top = TOP;
+    static const bool secondary = SECONDARY;
+    static const bool successor = SUCCESSOR; //the context has an incoming role
+    static const bool top_core = TOP_CORE; //the core is owl:Thing
+};
+
+//A context with its clauses as D, a Disjunction in general or a HornClause for
+//Horn ontologies; the contexts of either kind are kept in static members.
+template<typename D>
 class Context {
     public:
-	static bool UNLINK;
-
 
 	bool SPLIT;
 
@@ -171,60 +470,100 @@ class Context {
 	bool satisfiable;
 	bool processing;
 
-	unordered_multimap<ConceptID, Disjunction> axiom_index;
-	set<Disjunction> topush;
-	multiset<Disjunction, Disjunction::SizeLess> todo;
-	set<pair<RoleID, Context*> > forward_links;
-	set<Context*> backward_links;
-	set<pair<RoleID, Disjunction> > universals;
+	typedef unordered_multimap<ConceptID, D, std::tr1::hash<ConceptID>, equal_to<ConceptID>,
+	    CountingAllocator<pair<const ConceptID, D>, Memory::CONTEXTS> > Index;
+	typedef set<D, less<D>, CountingAllocator<D, Memory::CONTEXTS> > Clauses;
+	Index axiom_index;
+	Clauses topush;
+	multiset<D, typename D::SizeLess, CountingAllocator<D, Memory::CONTEXTS> > todo;
+	set<pair<RoleID, int>, less<pair<RoleID, int> >, CountingAllocator<pair<RoleID, int>, Memory::CONTEXTS> > forward_links; //by index
+	set<int, less<int>, CountingAllocator<int, Memory::CONTEXTS> > backward_links;
+	set<pair<RoleID, Disjunction>, less<pair<RoleID, Disjunction> >, CountingAllocator<pair<RoleID, Disjunction>, Memory::CONTEXTS> > universals;
 
 	vector<const AtomicConcept*> super;
 
+	int index; //in context_tracker
 	int axioms;
+	long long derived, rejected; //clauses kept and found redundant with profiling
+	int predecessors;
+	double seconds;
+
+	//axiom_index and topush can be in the store instead, see Residents
+	static Residents<Context> residents;
+	Store::Record record;
+	bool stored, changed, referenced;
+	void load() {
+	    referenced = true;
+	    if (stored)
+		reload();
+	}
+	void reload();
+	void unload();
+	bool cold() const { return !processing && todo.empty(); }
+	int pending() const { return todo.size(); }
 
 	//  public:
 	explicit Context(pair<RoleID, const Concept*>);
 	~Context();
 	void unlink();
 
-	void add(const Disjunction& a); //things to consider before pushing into todo
-	void link(RoleID r, Context* c);
+	void add(const D& a); //things to consider before pushing into todo
+	bool offer(const D& a); //the same without waking the context
+	template<typename P> void link(RoleID r, Context* c);
 	Context* secondary_context(RoleID r, const Concept* c);
+	void pull(Context* target);
+	typedef int (Context::*Kernel)();
+	static Kernel kernel[2][2]; //by successor and top core
+
 	int process();
-	void resolve_unary(const Disjunction& d, ConceptID head);
-	void resolve_binary(const Disjunction& d, ConceptID head, Context*);
-	void push(const Disjunction& d);
-	bool not_occurs(const  Disjunction& ax);
-	void remove_supersets(const Disjunction& ax);
+	template<typename P> int saturate();
+	template<typename P> void resolve_unary(const D& d, ConceptID head);
+	template<typename P> void resolve_binary(const D& d, ConceptID head, Context*);
+	template<typename P> void push(const vector<D>& batch);
+	template<typename P> bool not_occurs(const  D& ax);
+	void remove_supersets(const D& ax);
+
+	//secondary contexts are in the group of the core that they are secondary for,
+	//goal contexts have no key
+	static slab_tracker<pair<RoleID, const Concept*>, Context, Memory::CONTEXTS, ContextHash> context_tracker;
+	static vector<Context*> top_contexts;
+	static vector<list<Context*> > all_contexts;
+	static Scheduler<Context> active;
 };
 
-bool Context::UNLINK = true;
+template<typename D> typename Context<D>::Kernel Context<D>::kernel[2][2];
+template<typename D> Residents<Context<D> > Context<D>::residents;
+template<typename D> slab_tracker<pair<RoleID, const Concept*>, Context<D>, Memory::CONTEXTS, ContextHash> Context<D>::context_tracker;
+template<typename D> vector<Context<D>*> Context<D>::top_contexts;
+template<typename D> vector<list<Context<D>*> > Context<D>::all_contexts;
+template<typename D> Scheduler<Context<D> > Context<D>::active;
 
-tracker<pair<RoleID, const Concept*>, Context> context_tracker; //could try hash_tracker
-map<ConceptID, tracker<pair<RoleID, const Concept*>, Context> > secondary_context_tracker;
-vector<Context* > top_contexts;
-vector<list<Context*> > all_contexts;
-list<Context*> active;
-
-Context* Context::secondary_context(RoleID r, const Concept* c) {
-	ConceptID s = core->ID();
-	return secondary_context_tracker[s](make_pair(r, c));
+template<typename D>
+Context<D>* Context<D>::secondary_context(RoleID r, const Concept* c) {
+	return context_tracker(make_pair(r, c), core->ID());
 }
 
-Context::Context(pair<RoleID, const Concept*> rc) : core(rc.second), inrole(rc.first), top(core->type() == 'T'), satisfiable(true), processing(false), secondary(false) { 
-    todo.insert(Disjunction(Concept::concept_decompose(core)));
+template<typename D>
+Context<D>::Context(pair<RoleID, const Concept*> rc) : core(rc.second), inrole(rc.first), top(core->type() == 'T'), satisfiable(true), processing(false), secondary(false) { 
+    todo.insert(D(Concept::concept_decompose(core)));
 	if (!TOP_OPT && TOP_PRESENT)
-		todo.insert(Disjunction(factory.top()->ID()));
+		todo.insert(D(factory.top()->ID()));
     if (inrole) {
 	inexist = Concept::concept_decompose(factory.existential(factory.role(inrole), core));
 	if (top || !TOP_OPT)
-	FOREACH(range, ontology.role_range)
-	    if (ontology.hierarchy(inrole, range->first))
-		todo.insert(range->second);
+	FOREACH(range, ontology.role_ranges[inrole])
+	    todo.insert(D(*range));
     }
-    active.push_back(this);
+    active.push(this);
     all_contexts[inrole].push_back(this);
     axioms = 0;
+    derived = rejected = 0;
+    predecessors = 0;
+    seconds = 0;
+    stored = false;
+    changed = referenced = true;
+    if (inrole && !top)
+	residents.add(this);
 
     if (inrole)
 	context_succ_number++;
@@ -235,24 +574,84 @@ Context::Context(pair<RoleID, const Concept*> rc) : core(rc.second), inrole(rc.f
     SPLIT = (inrole == 0);
 }
 
-Context::~Context() { 
+template<typename D>
+Context<D>::~Context() { 
     if (UNLINK) 
 	unlink(); 
 }
 
-void Context::unlink() {
+template<typename D>
+void Context<D>::unlink() {
     //unlink and free
     FOREACH(i, forward_links)
-	i->second->backward_links.erase(this);
+	context_tracker[i->second]->backward_links.erase(index);
     FOREACH(i, backward_links)
-	(*i)->forward_links.erase(make_pair(inrole, this));
+	context_tracker[*i]->forward_links.erase(make_pair(inrole, index));
+}
+
+template<typename D>
+const D& get_clause(const D& d) {
+    return d;
+}
+
+template<typename D>
+const D& get_clause(const pair<const ConceptID, D>& i) {
+    return i.second;
+}
+
+//every clause as its length and literals, the clauses of axiom_index
+//and of topush each preceded by their number
+template<typename T>
+void write_clauses(const T& clauses, vector<int>& data) {
+    data.push_back(clauses.size());
+    FOREACH(i, clauses) {
+	const __typeof(get_clause(*i))& d = get_clause(*i);
+	data.push_back(d.size());
+	data.insert(data.end(), d.begin(), d.end());
+    }
+}
+
+template<typename D>
+void Context<D>::unload() {
+    if (changed) {
+	vector<int> data;
+	write_clauses(axiom_index, data);
+	write_clauses(topush, data);
+	record = store.write(data);
+	changed = false;
+    }
+    Index().swap(axiom_index);
+    Clauses().swap(topush);
+    stored = true;
+}
+
+template<typename D>
+void Context<D>::reload() {
+    vector<int> data;
+    store.read(record, data);
+    const int* p = &data[0];
+    for (int n = *p++; n > 0; n--, p += 1 + *p) {
+	D d(p + 1, p + 1 + *p);
+	axiom_index.insert(make_pair(Concept::clear_decompose(d.front()), d));
+    }
+    for (int n = *p++; n > 0; n--, p += 1 + *p)
+	topush.insert(topush.end(), D(p + 1, p + 1 + *p));
+    stored = false;
+    residents.add(this);
+}
+
+template<typename D>
+void Context<D>::add(const D& a) {
+    if (offer(a) && !processing)
+	active.push(this);
 }
 
-void Context::add(const Disjunction& a) {
+template<typename D>
+bool Context<D>::offer(const D& a) {
     if (satisfiable) {
 	if (!inrole) {
 	    int annot  = 0;
-	    for (ConceptID *i = a.end(); i != a.begin(); ) {
+	    for (const ConceptID *i = a.end(); i != a.begin(); ) {
 		i--;
 		if (Concept::is_annotated(*i)) 
 			annot++;
@@ -261,24 +660,33 @@ void Context::add(const Disjunction& a) {
 	    }
 
 	    if (annot > 1) {
-		return;
+		return false;
 	    }
 	}
 
 	todo.insert(a);
-	if (!processing) {
-	    if (top)
-		active.push_front(this);
-	    else
-		active.push_back(this);
-	}
+	return true;
     }
+    return false;
+}
+
+//what a target linked to late has pushed back already
+template<typename D>
+void Context<D>::pull(Context* target) {
+    target->load();
+    EQRANGE(j, axiom_index, Concept::clear_decompose(target->inexist))
+	if (j->second.front() == target->inexist)
+	    FOREACH(i, target->topush)
+		add(i->resolve(j->second));
 }
 
 //remove duplicates here
-void Context::link(RoleID r, Context* target) {
-	forward_links.insert(make_pair(r, target));
-	target->backward_links.insert(this);
+template<typename D> template<typename P>
+void Context<D>::link(RoleID r, Context* target) {
+	Statistics::Timer timer(PROFILE ? &statistics : NULL, Statistics::LINK);
+	forward_links.insert(make_pair(r, target->index));
+	if (target->backward_links.insert(index).second && PROFILE)
+		target->predecessors++;
 
 	link_number++;
 	max_forward_links = max(max_forward_links, (int) forward_links.size());
@@ -287,40 +695,78 @@ void Context::link(RoleID r, Context* target) {
 	if (top) {
 		FOREACH(c, all_contexts[inrole])
 			FOREACH(i, (*c)->universals) 
-			if (ontology.hierarchy(r, i->first)) 
-				target->add(i->second);
+			if (ontology.hierarchy(r, i->first)) {
+				target->add(D(i->second));
+				if (PROFILE)
+					statistics.derived(Statistics::LINK);
+			}
 	}
 	else {
 		FOREACH(i, universals)
-			if (ontology.hierarchy(r, i->first)) 
-				target->add(i->second);
+			if (ontology.hierarchy(r, i->first)) {
+				target->add(D(i->second));
+				if (PROFILE)
+					statistics.derived(Statistics::LINK);
+			}
 	}
 }
 
-void Context::resolve_unary(const Disjunction& ax, ConceptID head) {
-    EQRANGE(i, ontology.unary_axioms, head) 
-		add(i->second.resolve(ax));
+template<typename D> template<typename P>
+void Context<D>::resolve_unary(const D& ax, ConceptID head) {
+    Statistics::Timer timer(PROFILE ? &statistics : NULL, Statistics::RESOLVE_UNARY);
+    EQRANGE(i, ontology.unary_axioms, head) {
+		add(resolve(i->second, ax));
+		if (PROFILE)
+			statistics.derived(Statistics::RESOLVE_UNARY);
+    }
 }
 
-void Context::resolve_binary(const Disjunction& ax, ConceptID head, Context *con) {
+template<typename D> template<typename P>
+void Context<D>::resolve_binary(const D& ax, ConceptID head, Context *con) {
+	Statistics::Timer timer(PROFILE ? &statistics : NULL, Statistics::RESOLVE_BINARY);
+	con->load();
 	EQRANGE(i, ontology.binary_axioms, head) {
 	    EQRANGE(j, con->axiom_index, Concept::clear_decompose(i->second.first)) 
-		if (!Concept::decompose(i->second.first) || Concept::decompose(j->second.front())) 
+		if (!Concept::decompose(i->second.first) || Concept::decompose(j->second.front())) {
 	//	    if (inrole || !ax.has_annotated() || !j->second.has_annotated() || ax.back() == j->second.back())
-			add(i->second.second.resolve(ax, j->second));
+			add(resolve(i->second.second, ax, j->second));
+			if (PROFILE)
+				statistics.derived(Statistics::RESOLVE_BINARY);
+		}
 	}
 }
 
-void Context::push(const Disjunction& d) {
-    FOREACH(source, backward_links)
-	EQRANGE(j, (*source)->axiom_index, Concept::clear_decompose(inexist))
-	if (j->second.front() == inexist)  
-	    (*source)->add(d.resolve(j->second));
+//every predecessor looks up its clauses on inexist once for the whole batch
+//and is woken once for all that it gets
+template<typename D> template<typename P>
+void Context<D>::push(const vector<D>& batch) {
+    Statistics::Timer timer(PROFILE ? &statistics : NULL, Statistics::PUSH);
+    ConceptID key = Concept::clear_decompose(inexist);
+    vector<const D*> premises;
+    FOREACH(i, backward_links) {
+	Context* source = context_tracker[*i];
+	source->load();
+	premises.clear();
+	EQRANGE(j, source->axiom_index, key)
+	    if (j->second.front() == inexist)
+		premises.push_back(&j->second);
+	bool woken = false;
+	FOREACH(d, batch)
+	    FOREACH(j, premises) {
+		woken |= source->offer(d->resolve(**j));
+		if (PROFILE)
+		    statistics.derived(Statistics::PUSH);
+	    }
+	if (woken && !source->processing)
+	    active.push(source);
+    }
 }
 
-bool Context::not_occurs(const  Disjunction& ax) {
-    if (SUBSET_OPT) {
-	for (ConceptID* c = ax.begin(); c != ax.end(); c++)
+template<typename D> template<typename P>
+bool Context<D>::not_occurs(const  D& ax) {
+    Statistics::Timer timer(PROFILE ? &statistics : NULL, Statistics::NOT_OCCURS);
+    if (P::subset) {
+	for (const ConceptID* c = ax.begin(); c != ax.end(); c++)
 	    EQRANGE(j, axiom_index, Concept::clear_decompose(*c)) {
 		if (j->second.subset(ax)) {
 		    return false;
@@ -344,36 +790,45 @@ bool Context::not_occurs(const  Disjunction& ax) {
     }
 }
 
-void Context::remove_supersets(const Disjunction& ax) {
+template<typename D>
+void Context<D>::remove_supersets(const D& ax) {
 	FOREACH(j, axiom_index)
 		if (ax.subset(j->second))
 			axiom_index.erase(j);
 }
 
 
-int Context::process() {
+template<typename D> template<typename P>
+int Context<D>::saturate() {
 	//cerr << "process " << core->to_string() << endl;
 	processing = true;
+	double start = PROFILE ? Statistics::wall() : 0;
+	//the new clauses to push back for a clause, delivered together
+	vector<D> outbox;
 
 	while (!todo.empty()) {
 		if (!satisfiable)
 			cerr << "Internal error: processing an unsatisfiable context" << endl;
-		Disjunction ax = *todo.begin();
+		D ax = *todo.begin();
 		todo.erase(todo.begin());
 		if (ax.size() == 0) {
 			satisfiable = false;
+			if (PROFILE)
+				statistics.event(Statistics::UNSATISFIABLE);
 			if (VERBOSE) {
 				cout << "UNSAT ";
 				if (secondary)
 					cout << "!";
-				if (inrole)
+				if (P::successor)
 					cout << factory.role(inrole)->to_string() << ",";
 				cout  <<  core->to_string() << endl;
 			}
-			if (!inrole && !goals_set)
+			if (!P::successor && !goals_set)
 				formatter.unsatisfiable(core);
 			//if this == top can end here
-			push(Disjunction::bottom);
+			outbox.assign(1, D(Disjunction::bottom));
+			push<P>(outbox);
+			outbox.clear();
 			unlink();
 
 			axiom_index.clear();
@@ -383,25 +838,30 @@ int Context::process() {
 			backward_links.clear();
 			universals.clear();
 
-			topush.insert(Disjunction::bottom);
+			topush.insert(D(Disjunction::bottom));
 		}
 
-		else if (not_occurs(ax)) {
-		    if (REMOVE_OPT)
+		else if (not_occurs<P>(ax)) {
+		    if (PROFILE) {
+			statistics.event(Statistics::NOT_OCCURS_MISS);
+			derived++;
+		    }
+		    if (P::remove)
 			remove_supersets(ax);
 		    ConceptID head = Concept::clear_decompose(ax.front());
-		    const Concept* norm = factory.concept(head);
+		    const Dispatch& rule = ontology.dispatch(head);
+		    const Concept* norm = rule.concept;
 		    axiom_index.insert(make_pair(head, ax));
 
 
 		    if (VERBOSE) {
 			if (secondary)
 			    cout << "!";
-			if (inrole)
+			if (P::successor)
 			    cout << factory.role(inrole)->to_string() << ",";
 			cout	<< core->to_string() << " [= " << write_disjunction(ax) << endl;
 		    }
-		    if (inrole) {
+		    if (P::successor) {
 			axiom_succ_number++;
 			max_succ_axioms = max(max_succ_axioms, (int) axiom_index.size());
 			total_succ_length += ax.size();
@@ -417,9 +877,11 @@ int Context::process() {
 
 			if (Concept::is_annotated(head)) {
 
-				if (inrole) {
-					Pusher p(ax, inrole);
+				if (P::successor) {
+					Pusher<D> p(ax, inrole);
 					do {
+						if (PROFILE)
+							statistics.event(Statistics::PUSHER_PRODUCT);
 //						if (!top && p.disjunction().size() == 1 && p.disjunction().front() == Concept::clear_decompose(inexist))
 //							continue;
 						if (topush.find(p.disjunction()) == topush.end()) {
@@ -428,16 +890,20 @@ int Context::process() {
 							topush_number++;
 							max_topush = max(max_topush, (int) topush.size());
 
-
-							if (top) {
-								FOREACH(c, all_contexts[inrole]) 
-									(*c)->push(p.disjunction());
-							}
-							else 
-								push(p.disjunction());
+							outbox.push_back(p.disjunction());
 						}
 					} while (p.next());
 
+					if (!outbox.empty()) {
+						if (P::top_core) {
+							FOREACH(c, all_contexts[inrole]) 
+								(*c)->template push<P>(outbox);
+						}
+						else 
+							push<P>(outbox);
+						outbox.clear();
+					}
+
 				}
 				else {
 				    if (goals_set) 
@@ -449,145 +915,487 @@ int Context::process() {
 
 			else { 
 
-				resolve_unary(ax, head);
-				if (top) {
-					FOREACH(c, all_contexts[inrole])
-						(*c)->resolve_binary(ax, head, *c);
-				}
-				else {
-					resolve_binary(ax, head, this);
-					if (TOP_OPT) 
-						resolve_binary(ax, head, top_contexts[inrole]);
+				if (rule.unary[0])
+					resolve_unary<P>(ax, head);
+				if (rule.binary[0]) {
+					if (P::top_core) {
+						FOREACH(c, all_contexts[inrole])
+							(*c)->template resolve_binary<P>(ax, head, *c);
+					}
+					else {
+						resolve_binary<P>(ax, head, this);
+						if (P::top) 
+							resolve_binary<P>(ax, head, top_contexts[inrole]);
+					}
 				}
 
 				if (Concept::decompose(ax.front())) {
-					if (norm->type() == 'C')
-						resolve_unary(ax, ax.front());
+					if (rule.type == 'C' && rule.unary[1])
+						resolve_unary<P>(ax, ax.front());
 
-					if (norm->type() == 'D') {
+					if (rule.type == 'D') {
 					    if (ax.size() == 1 && SPLIT) {
 						Disjunction d = ontology.unary_axioms.find(ax.front())->second;
-						add(Disjunction(d.front(), split_ID[0]));
-						add(Disjunction(split_ID[1]).resolve(d));
+						add(D(d.front(), split_ID[0]));
+						add(D(Disjunction(split_ID[1]).resolve(d)));
 						SPLIT = false;
+						if (PROFILE)
+							statistics.event(Statistics::SPLIT);
 					    }
 					    else 
-						resolve_unary(ax, ax.front());
+						resolve_unary<P>(ax, ax.front());
 					}
 
 
-					if (norm->type() == 'N' || norm->type() == 'U') {
-						resolve_binary(ax, ax.front(), this);
-						if (TOP_OPT)
-							resolve_binary(ax, ax.front(), top_contexts[inrole]);
+					if ((rule.type == 'N' || rule.type == 'U') && rule.binary[1]) {
+						resolve_binary<P>(ax, ax.front(), this);
+						if (P::top)
+							resolve_binary<P>(ax, ax.front(), top_contexts[inrole]);
 					}
 
-					if (norm->type() == 'E') {
-						const ExistentialConcept* e = (const ExistentialConcept*) norm;
-						RoleID r = e->role()->ID();
+					if (rule.type == 'E') {
+						RoleID r = rule.role;
 
 						bool secondary_target = false;
-						if (SECONDARY_OPT)
+						if (P::secondary)
 						FOREACH(u, universals)
 							if (ontology.hierarchy(r, u->first))
 								secondary_target = true;
 
-						Context* target = (secondary_target) ? secondary_context(r, e->concept()) : context_tracker(make_pair(r, e->concept()));
+						Context* target = (secondary_target) ? secondary_context(r, rule.filler) : context_tracker(make_pair(r, rule.filler));
 						if (target->satisfiable) {
-							link(r, target);
-							if (TOP_OPT)
+							link<P>(r, target);
+							if (P::top)
 								FOREACH(i, top_contexts[r]->topush) 
 									add(i->resolve(ax));
 						}
+						target->load();
 						FOREACH(i, target->topush)  {
 							add(i->resolve(ax));
 						}
 					}
 
-					if (norm->type() == 'U') {
-						resolve_unary(ax, ax.front()); // for transitivity
+					if (rule.type == 'U') {
+						if (rule.unary[1])
+							resolve_unary<P>(ax, ax.front()); // for transitivity
 
-						const UniversalConcept *u = (const UniversalConcept*) norm;
-						RoleID r = u->role()->ID();
-						Disjunction d(Concept::concept_decompose(u->concept()), Concept::annotate(factory.negation(u->concept())->ID()));
-						if (top) {
+						RoleID r = rule.role;
+						const Disjunction& d = rule.successor;
+						if (P::top_core) {
 							FOREACH(c, all_contexts[inrole]) {
 								(*c)->universals.insert(make_pair(r, d));
 								FOREACH(i, (*c)->forward_links) 
 									if (ontology.hierarchy(i->first, r)) 
-										i->second->add(d);
+										context_tracker[i->second]->add(D(d));
 							}
 						}
 						else {
 							universals.insert(make_pair(r, d));
 
-							if (SECONDARY_OPT) {
+							if (P::secondary) {
 								list<pair<Context*, Context*> > redirect;
 								FOREACH(i, forward_links) 
 									if (ontology.hierarchy(i->first, r)) {
-										if (!i->second->secondary)
-											redirect.push_back(make_pair(i->second, secondary_context(i->first, i->second->core)));
+										Context* target = context_tracker[i->second];
+										if (!target->secondary)
+											redirect.push_back(make_pair(target, secondary_context(i->first, target->core)));
 										else
-											i->second->add(d);
+											target->add(D(d));
 									}
 
 								FOREACH(c, redirect) {
 									c->second->secondary = true;
-									forward_links.erase(make_pair(c->second->inrole, c->first));
-									c->first->backward_links.erase(this);
-									link(c->second->inrole, c->second);
-									//PUSH!
+									forward_links.erase(make_pair(c->second->inrole, c->first->index));
+									c->first->backward_links.erase(index);
+									link<P>(c->second->inrole, c->second);
+									pull(c->second);
 
-									if (TOP_OPT)
+									if (P::top)
 										FOREACH(i, top_contexts[inrole]->forward_links) 
-											if (ontology.hierarchy(i->first, r)) 
-												link(i->first, secondary_context(i->first, i->second->core));
-									//PUSH!
+											if (ontology.hierarchy(i->first, r)) {
+												Context* s = secondary_context(i->first, context_tracker[i->second]->core);
+												link<P>(i->first, s);
+												pull(s);
+											}
 								}
 							}
 							else {
 								FOREACH(i, forward_links)
 									if (ontology.hierarchy(i->first, r)) 
-										i->second->add(d);
-								if (TOP_OPT)
+										context_tracker[i->second]->add(D(d));
+								if (P::top)
 									FOREACH(i, top_contexts[inrole]->forward_links) 
 										if (ontology.hierarchy(i->first, r)) 
-											i->second->add(d);
+											context_tracker[i->second]->add(D(d));
 							}
 						}
 					}
 				}
 
-				if (inrole) {
-					if (ontology.universal_axioms.find(make_pair(head, inrole)) != ontology.universal_axioms.end()) 
+				if (P::successor) {
+					if (rule.universal && ontology.universal_axioms.find(make_pair(head, inrole)) != ontology.universal_axioms.end()) 
 						add(ax.annotate());
 				}
 				else {
-					if (norm->type() == 'A') 
+					if (rule.type == 'A') 
 						add(ax.annotate());
 				}
 			}
 		}
+		else if (PROFILE) {
+			statistics.event(Statistics::NOT_OCCURS_HIT);
+			rejected++;
+		}
 	}
 	processing = false;
+	if (PROFILE)
+		seconds += Statistics::wall() - start;
 	return 0;
 }
 
+template<typename D>
+int Context<D>::process() {
+	load();
+	changed = true;
+	return (this->*kernel[inrole != 0][top])();
+}
+
+template<typename D, bool S, bool R, bool T, bool C>
+void set_kernels() {
+	Context<D>::kernel[0][0] = &Context<D>::template saturate<Policy<S, R, T, C, false, false> >;
+	Context<D>::kernel[0][1] = &Context<D>::template saturate<Policy<S, R, T, C, false, true> >;
+	Context<D>::kernel[1][0] = &Context<D>::template saturate<Policy<S, R, T, C, true, false> >;
+	Context<D>::kernel[1][1] = &Context<D>::template saturate<Policy<S, R, T, C, true, true> >;
+}
+
+template<typename D, bool S, bool R, bool T>
+void set_kernels(bool c) {
+	if (c)
+		set_kernels<D, S, R, T, true>();
+	else
+		set_kernels<D, S, R, T, false>();
+}
+
+template<typename D, bool S, bool R>
+void set_kernels(bool t, bool c) {
+	if (t)
+		set_kernels<D, S, R, true>(c);
+	else
+		set_kernels<D, S, R, false>(c);
+}
+
+template<typename D, bool S>
+void set_kernels(bool r, bool t, bool c) {
+	if (r)
+		set_kernels<D, S, true>(t, c);
+	else
+		set_kernels<D, S, false>(t, c);
+}
+
+template<typename D>
+void set_kernels() {
+	if (SUBSET_OPT)
+		set_kernels<D, true>(REMOVE_OPT, TOP_OPT, SECONDARY_OPT);
+	else
+		set_kernels<D, false>(REMOVE_OPT, TOP_OPT, SECONDARY_OPT);
+}
+
+//picks the kernels of Context::process for the clauses and the command-line options
+void set_kernels() {
+	if (HORN)
+		set_kernels<HornClause>();
+	else
+		set_kernels<Disjunction>();
+}
+
+//keeps the context if it is among the slowest to saturate
+template<typename C>
+void note_cost(C* c) {
+    if (!statistics.hot(c->seconds))
+	return;
+    c->load();
+    Statistics::ContextCost k;
+    k.name = c->core->to_string();
+    if (c->inrole)
+	k.name = factory.role(c->inrole)->to_string() + "," + k.name;
+    k.seconds = c->seconds;
+    k.clauses = c->derived;
+    k.rejected = c->rejected;
+    k.forward_links = c->forward_links.size();
+    k.backward_links = c->predecessors;
+    k.topush = c->topush.size();
+    statistics.context(k);
+}
+
+//successor contexts are noted when classification is over, goal contexts when they are done
+void note_costs() {
+    vector<Context<Disjunction>*> v = Context<Disjunction>::context_tracker.get_range();
+    FOREACH(c, v)
+	note_cost(*c);
+    vector<Context<HornClause>*> h = Context<HornClause>::context_tracker.get_range();
+    FOREACH(c, h)
+	note_cost(*c);
+}
+
+template<typename D>
 void clear() {
-    Context::UNLINK = false;
-    top_contexts.clear();
-    all_contexts.clear();
-    context_tracker.clear();
-	secondary_context_tracker.clear();
-    Context::UNLINK = true;
+    Context<D>::residents.clear();
+    Context<D>::top_contexts.clear();
+    Context<D>::all_contexts.clear();
+    Context<D>::context_tracker.clear();
+}
+
+void clear() {
+    UNLINK = false;
+    clear<Disjunction>();
+    clear<HornClause>();
+    UNLINK = true;
+}
+
+int percent = 1;
+
+//the memory of workers is not seen by the parent
+void print_progress(int p) {
+    cerr << "\r" << p << "%";
+    if (WORKERS == 1)
+	cerr << "  memory " << Memory::megabytes(Memory::bytes()) << " (peak " << Memory::megabytes(Memory::peak_bytes()) << ")   ";
+}
+
+void show_progress(int progress, int total) {
+    if (progress*100 <= total*percent)
+	return;
+    while (progress*100 > total*percent)
+	percent++;
+    print_progress(percent-1);
+}
+
+//the goal context is the only one without a key, and the first to be released
+template<typename D>
+bool saturate(const Concept* goal, ostream& output) {
+    typedef Context<D> C;
+    C& now = *C::context_tracker.anonymous(make_pair(0, goal));
+    while (!C::active.empty()) {
+	C *c = C::active.pop();
+	c->process();
+	if (MEMORY_LIMIT)
+	    C::residents.evict();
+    }
+
+    if (goals_set) {
+	output << endl << goal->to_string() << endl;
+	if (now.satisfiable) {
+	    sort(now.super.begin(), now.super.end(), AtomicConcept::AlphaLess());
+	    FOREACH(x, now.super)
+		output << "  " << (*x)->to_string() << endl;
+	}
+	else
+	    output << "  owl:Nothing" << endl;
+    }
+
+    C::all_contexts[0].pop_back();
+    if (PROFILE)
+	note_cost(&now);
+    bool satisfiable = now.satisfiable;
+    C::context_tracker.release(&now);
+    return satisfiable;
+}
+
+bool classify(const Concept* goal, ostream& output) {
+    Trace::Scope scope(trace, "saturate", trace.on() ? goal->to_string() : "");
+    bool satisfiable = HORN ? saturate<HornClause>(goal, output) : saturate<Disjunction>(goal, output);
+    formatter.done(goal);
+    return satisfiable;
+}
+
+//goals with an unsatisfiable told subsumer are not saturated; they come after
+//their told subsumers, so this reaches down chains of told subsumptions
+void classify(const vector<const Concept*>& goals, ostream& output, bool progress) {
+    int n = 0;
+    FOREACH(a, goals) {
+	if (progress)
+	    show_progress(++n, goals.size());
+	if (told && told->known_unsatisfiable(*a)) {
+	    formatter.unsatisfiable(*a);
+	    formatter.done(*a);
+	    told->unsatisfiable(*a); //for the goals below, which come later
+	}
+	else if (!classify(*a, output) && told)
+	    told->unsatisfiable(*a);
+    }
+}
+
+//the counters of saturation, which a worker starts from zero and sends to the
+//parent when it is done; the parent adds them to its own
+void reset_counters() {
+    statistics.reset();
+    context_init_number = context_succ_number = 0;
+    axiom_init_number = axiom_succ_number = 0;
+    total_init_length = total_succ_length = 0;
+    max_init_axioms = max_succ_axioms = max_init_length = max_succ_length = 0;
+    link_number = max_forward_links = max_backward_links = 0;
+    topush_number = max_topush = 0;
+    store.writes = store.reads = store.bytes_written = store.bytes_read = 0;
+}
+
+vector<long long> counters() {
+    vector<long long> v;
+    statistics.counters(v);
+    long long c[] = { context_init_number, context_succ_number, axiom_init_number, axiom_succ_number,
+	(long long) total_init_length, (long long) total_succ_length, link_number, topush_number,
+	store.writes, store.reads, store.bytes_written, store.bytes_read,
+	max_init_axioms, max_succ_axioms, max_init_length, max_succ_length,
+	max_forward_links, max_backward_links, max_topush };
+    v.insert(v.end(), c, c + sizeof(c) / sizeof(c[0]));
+    return v;
+}
+
+void add_counters(const vector<long long>& v) {
+    int i = statistics.add(v, 0);
+    context_init_number += v[i++];
+    context_succ_number += v[i++];
+    axiom_init_number += v[i++];
+    axiom_succ_number += v[i++];
+    total_init_length += v[i++];
+    total_succ_length += v[i++];
+    link_number += v[i++];
+    topush_number += v[i++];
+    store.writes += v[i++];
+    store.reads += v[i++];
+    store.bytes_written += v[i++];
+    store.bytes_read += v[i++];
+    max_init_axioms = max(max_init_axioms, (int) v[i++]);
+    max_succ_axioms = max(max_succ_axioms, (int) v[i++]);
+    max_init_length = max(max_init_length, (int) v[i++]);
+    max_succ_length = max(max_succ_length, (int) v[i++]);
+    max_forward_links = max(max_forward_links, (int) v[i++]);
+    max_backward_links = max(max_backward_links, (int) v[i++]);
+    max_topush = max(max_topush, (int) v[i++]);
+}
+
+//every job is classified in a forked copy of this process, results come back through pipes
+void classify_parallel(const vector<vector<const Concept*> >& jobs, int total) {
+    vector<pid_t> pids;
+    vector<struct pollfd> fds;
+    cout.flush();
+    FOREACH(j, jobs) {
+	int p[2];
+	if (pipe(p) != 0) {
+	    cerr << "Error creating a pipe for a worker process." << endl;
+	    exit(1);
+	}
+	pid_t pid = fork();
+	if (pid < 0) {
+	    cerr << "Error creating a worker process." << endl;
+	    exit(1);
+	}
+	if (pid == 0) {
+	    close(p[0]);
+	    stringstream name;
+	    name << "worker " << pids.size() + 1;
+	    trace.name_process(name.str());
+	    formatter.redirect(p[1]);
+	    reset_counters();
+	    classify(*j, cout, false);
+	    if (HOT) {
+		note_costs();
+		cerr << endl;
+		statistics.report(cerr);
+	    }
+	    formatter.send_counters(counters());
+	    formatter.flush();
+	    cout.flush();
+	    _exit(0);
+	}
+	close(p[1]);
+	pids.push_back(pid);
+	struct pollfd f;
+	f.fd = p[0];
+	f.events = POLLIN;
+	fds.push_back(f);
+    }
+
+    int progress = 0;
+    int open = fds.size();
+    while (open > 0) {
+	if (poll(&fds[0], fds.size(), -1) < 0)
+	    continue;
+	FOREACH(f, fds)
+	    if (f->fd >= 0 && (f->revents & (POLLIN | POLLHUP | POLLERR))) {
+		int k = formatter.receive(f->fd);
+		if (k < 0) {
+		    vector<long long> v = formatter.counters(f->fd);
+		    if (v.size() == counters().size())
+			add_counters(v);
+		    else
+			cerr << "Internal error: no statistics from a worker process" << endl;
+		    close(f->fd);
+		    f->fd = -1;
+		    open--;
+		}
+		else if (k > 0)
+		    show_progress(progress += k, total);
+	    }
+    }
+
+    FOREACH(pid, pids) {
+	int status;
+	waitpid(*pid, &status, 0);
+	if (!WIFEXITED(status) || WEXITSTATUS(status) != 0) {
+	    cerr << endl << "Error: a worker process failed." << endl;
+	    exit(1);
+	}
+    }
+}
+
+//one query per line, answered in the layout of the goals:
+//  subsumed A B      true or false
+//  subsumers A       all classes that A is a subclass of
+//  subclasses A      all subclasses of A
+//  lcs A B           the least common subsumers of A and B
+void answer_queries(istream& queries, ostream& output) {
+    Taxonomy* taxonomy = formatter.taxonomy();
+    string line;
+    while (getline(queries, line)) {
+	stringstream ss(line);
+	string q, s;
+	vector<int> a;
+	ss >> q;
+	while (ss >> s) {
+	    a.push_back(taxonomy->find(s));
+	    if (a.back() == Taxonomy::UNKNOWN) {
+		cerr << "Warning: " << s << " does not occur in the ontology." << endl;
+		break;
+	    }
+	}
+	if (q.empty() || (!a.empty() && a.back() == Taxonomy::UNKNOWN))
+	    continue;
+
+	vector<int> r;
+	output << endl << line << endl;
+	if (q == "subsumed" && a.size() == 2)
+	    output << "  " << (taxonomy->subsumed(a[0], a[1]) ? "true" : "false") << endl;
+	else if (q == "subsumers" && a.size() == 1)
+	    r = taxonomy->subsumers(a[0]);
+	else if (q == "subclasses" && a.size() == 1)
+	    r = taxonomy->subclasses(a[0]);
+	else if (q == "lcs" && a.size() == 2)
+	    r = taxonomy->least_common_subsumers(a[0], a[1]);
+	else
+	    cerr << "Warning: unknown query: " << line << endl;
+	FOREACH(x, r)
+	    output << "  " << taxonomy->name(*x) << endl;
+    }
+    delete taxonomy;
 }
 
+template<typename D>
 void set_top_contexts() {
+	vector<Context<D>*>& top_contexts = Context<D>::top_contexts;
 	top_contexts.reserve(Role::number());
 
-	top_contexts[0] = context_tracker(make_pair(0, factory.top()));
+	top_contexts[0] = Context<D>::context_tracker(make_pair(0, factory.top()));
 	FOREACH(r, ontology.positive_roles) 
-		top_contexts[*r] = context_tracker(make_pair(*r, factory.top()));
+		top_contexts[*r] = Context<D>::context_tracker(make_pair(*r, factory.top()));
 
 	top_contexts[0]->process();
 	FOREACH(r, ontology.positive_roles) 
@@ -599,8 +1407,11 @@ int main(int argc, char* argv[]) {
     ifstream input;
     ofstream output;
     ifstream goals_file;
+    ifstream queries_file;
     int input_set = 0;
     int output_set = 0;
+    int stats_set = 0;
+    int queries_set = 0;
 
     for (int i = 1; i < argc; i++)  {
 
@@ -619,6 +1430,17 @@ int main(int argc, char* argv[]) {
 	    cout << "-i  (--input): follow by the input file" << endl;
 	    cout << "-n  (--nooutput): classify the ontology but suppress the output" << endl;
 	    cout << "-o  (--output): follow by the output file" << endl;
+	    cout << "-f  (--format): follow by owl (default), binary or jsonl for the format of the output" << endl;
+	    cout << "-p  (--parallel): follow by the number of worker processes" << endl;
+	    cout << "-r  (--schedule): follow by fifo (default), lifo, smallest, role or goal for the order\n"
+		"    in which contexts are processed" << endl;
+	    cout << "-m  (--memory): follow by N to keep the memory of contexts and clauses near N megabytes by moving\n"
+		"    saturated ones to a temporary file (in TMPDIR), at the cost of time" << endl;
+	    cout << "-s  (--stats): follow by a file for rule and phase statistics in JSON" << endl;
+	    cout << "-k  (--hot): follow by N to report the N contexts that took longest to saturate" << endl;
+	    cout << "-t  (--trace): follow by a file for a timeline of the run in Chrome trace format" << endl;
+	    cout << "-q  (--query): follow by a file of queries about the classified ontology, one per line:" << endl;
+	    cout << "      subsumed A B, subsumers A, subclasses A or lcs A B" << endl;
 //	    cout << "-g  (--goals): follow by a file containing a list of classification goals" << endl;
 //	    cout << "-l  (--log): write performance log into condor.log" << endl;
 	    return 0;
@@ -667,6 +1489,106 @@ int main(int argc, char* argv[]) {
 	    return 0;
 	}
 
+	if (strcmp(argv[i], "-q") == 0 || strcmp(argv[i], "--query") == 0) {
+	    if (++i < argc) {
+		queries_file.open(argv[i]);
+		if (!queries_file.is_open()) {
+		    cerr << "Error opening query file: " << argv[i] << endl;
+		    return 0;
+		}
+		queries_set = i;
+		OUTPUT = false;
+		continue;
+	    }
+	    cerr << "Query file expected after -q or --query." << endl;
+	    return 0;
+	}
+
+	if (strcmp(argv[i], "-f") == 0 || strcmp(argv[i], "--format") == 0) {
+	    if (++i < argc) {
+		if (strcmp(argv[i], "owl") == 0)
+		    FORMAT = Formatter::OWL;
+		else if (strcmp(argv[i], "binary") == 0)
+		    FORMAT = Formatter::BINARY;
+		else if (strcmp(argv[i], "jsonl") == 0)
+		    FORMAT = Formatter::JSONL;
+		else {
+		    cerr << "Unknown output format: " << argv[i] << endl;
+		    return 0;
+		}
+		continue;
+	    }
+	    cerr << "Output format expected after -f or --format." << endl;
+	    return 0;
+	}
+
+	if (strcmp(argv[i], "-p") == 0 || strcmp(argv[i], "--parallel") == 0) {
+	    if (++i < argc && atoi(argv[i]) > 0) {
+		WORKERS = atoi(argv[i]);
+		continue;
+	    }
+	    cerr << "Number of workers expected after -p or --parallel." << endl;
+	    return 0;
+	}
+
+	if (strcmp(argv[i], "-r") == 0 || strcmp(argv[i], "--schedule") == 0) {
+	    if (++i < argc) {
+		int k = 0;
+		while (k < SCHEDULES && strcmp(argv[i], schedule_names[k]) != 0)
+		    k++;
+		if (k == SCHEDULES) {
+		    cerr << "Unknown schedule: " << argv[i] << endl;
+		    return 0;
+		}
+		SCHEDULE = (Schedule) k;
+		continue;
+	    }
+	    cerr << "Schedule expected after -r or --schedule." << endl;
+	    return 0;
+	}
+
+	if (strcmp(argv[i], "-m") == 0 || strcmp(argv[i], "--memory") == 0) {
+	    if (++i < argc && atoi(argv[i]) > 0) {
+		MEMORY_LIMIT = atoi(argv[i]) * 1048576LL;
+		continue;
+	    }
+	    cerr << "Number of megabytes expected after -m or --memory." << endl;
+	    return 0;
+	}
+
+	if (strcmp(argv[i], "-s") == 0 || strcmp(argv[i], "--stats") == 0) {
+	    if (++i < argc) {
+		stats_set = i;
+		PROFILE = true;
+		continue;
+	    }
+	    cerr << "Statistics file expected after -s or --stats." << endl;
+	    return 0;
+	}
+
+	if (strcmp(argv[i], "-k") == 0 || strcmp(argv[i], "--hot") == 0) {
+	    if (++i < argc && atoi(argv[i]) > 0) {
+		statistics.keep_hot(atoi(argv[i]));
+		HOT = true;
+		PROFILE = true;
+		continue;
+	    }
+	    cerr << "Number of contexts expected after -k or --hot." << endl;
+	    return 0;
+	}
+
+	if (strcmp(argv[i], "-t") == 0 || strcmp(argv[i], "--trace") == 0) {
+	    if (++i < argc) {
+		if (!trace.open(argv[i])) {
+		    cerr << "Error opening trace file: " << argv[i] << endl;
+		    return 0;
+		}
+		continue;
+	    }
+	    cerr << "Trace file expected after -t or --trace." << endl;
+	    return 0;
+	}
+
 	if (strcmp(argv[i], "-n") == 0 || strcmp(argv[i], "--nooutput") == 0) {
 	    OUTPUT = false;
 	    continue;
@@ -716,6 +1638,30 @@ int main(int argc, char* argv[]) {
 		SECONDARY_OPT = true;
 		continue;
 	}
+	if (strcmp(argv[i], "-horn0") == 0) {
+		HORN_OPT = false;
+		continue;
+	}
+	if (strcmp(argv[i], "-horn1") == 0) {
+		HORN_OPT = true;
+		continue;
+	}
+	if (strcmp(argv[i], "-told0") == 0) {
+		TOLD_OPT = false;
+		continue;
+	}
+	if (strcmp(argv[i], "-told1") == 0) {
+		TOLD_OPT = true;
+		continue;
+	}
+	if (strcmp(argv[i], "-mod0") == 0) {
+		MODULE_OPT = false;
+		continue;
+	}
+	if (strcmp(argv[i], "-mod1") == 0) {
+		MODULE_OPT = true;
+		continue;
+	}
 
 	cerr << "Unrecognized argument. Use -h for help." << endl;
 	return 0;
@@ -725,7 +1671,8 @@ int main(int argc, char* argv[]) {
 
     clock_t timepoint[4];
     timepoint[0] = clock();
-
+    statistics.phase("parse");
+    trace.begin("parse");
 
     cerr << "PARSING from ";
     Parser p;
@@ -740,6 +1687,7 @@ int main(int argc, char* argv[]) {
     }
 
     vector<const Concept*> goals;
+    vector<const Concept*> signature;
     if (goals_set) {
 	cerr << "READING GOALS from " << argv[goals_set] << endl;
 	string line;
@@ -751,6 +1699,7 @@ int main(int argc, char* argv[]) {
 		a.push_back(factory.atomic(s));
 		if (factory.atomic_tracker.was_new())
 		    cerr << "Warning: " << s << " does not occur in the ontology." << endl;
+		signature.push_back(a.back());
 	    }
 
 	    if (a.size() == 1) 
@@ -771,10 +1720,33 @@ int main(int argc, char* argv[]) {
 	    goals.push_back(*x);
     }
 
+    trace.end();
     timepoint[1] = clock();
+    statistics.phase("normalize");
     cerr << "CLASSIFICATION" << endl;
 
+    if (goals_set && MODULE_OPT) {
+	trace.begin("module extraction");
+	int n = ontology.told_subsumptions.size() + ontology.told_disjoints.size();
+	int m = ontology.module(signature);
+	cerr << "MODULE of " << m << " out of " << n << " axioms" << endl;
+	trace.end();
+    }
+
+    trace.begin("normalize");
     ontology.normalize();
+    trace.end();
+
+    if (goals_set && WORKERS > 1) {
+	cerr << "Warning: -p is ignored together with -g." << endl;
+	WORKERS = 1;
+    }
+
+    //only the goals are classified, there is no taxonomy to query
+    if (goals_set && queries_set) {
+	cerr << "Warning: -q is ignored together with -g." << endl;
+	queries_set = 0;
+    }
 
     /*
     cout << "UNARY" << endl;
@@ -794,66 +1766,101 @@ int main(int argc, char* argv[]) {
     ontology.binary_axioms.insert(make_pair(split_ID[0], make_pair(split_ID[1], Disjunction())));
     ontology.binary_axioms.insert(make_pair(split_ID[1], make_pair(split_ID[0], Disjunction())));
 
+    trace.begin("compile");
+    ontology.compile();
+    trace.end();
+
 
 
 	TOP_PRESENT = (ontology.unary_axioms.find(factory.top()->ID()) != ontology.unary_axioms.end());
 	TOP_OPT = TOP_OPT && TOP_PRESENT;
 
-	all_contexts.resize(Role::number());
-	if (TOP_OPT)
-		set_top_contexts();
-
-       int progress = 0;
-       int total = goals.size();
-       int percent = 1;
-//    for (vector<const AtomicConcept*>::reverse_iterator a = atomics.rbegin();  a != atomics.rend(); a++) {
-       FOREACH(a, goals) {
-	progress++;
-	while (progress*100 > total*percent) {
-	    cerr << "\b\b\b" << percent << "%";
-	    percent++;
-	}
-
-	Context now(make_pair(0, *a));
-	while (!active.empty()) {
-	    Context *c = active.front();
-	    active.pop_front();
-	    c->process();
-	}
-
-	if (goals_set) {
-	    (output_set ? output : cout) << endl << (*a)->to_string() << endl;
-	    if (now.satisfiable) {
-		sort(now.super.begin(), now.super.end(), AtomicConcept::AlphaLess());
-		FOREACH(x, now.super)
-		    (output_set ? output : cout) << "  " << (*x)->to_string() << endl;
-	    }
-	    else
-		(output_set ? output : cout) << "  owl:Nothing" << endl;
+	HORN = HORN_OPT && ontology.horn();
+	if (HORN)
+		cerr << "HORN ontology" << endl;
+
+	statistics.phase("saturate");
+	set_kernels();
+	Context<Disjunction>::all_contexts.resize(Role::number());
+	Context<HornClause>::all_contexts.resize(Role::number());
+	if (TOP_OPT) {
+		trace.begin("top contexts");
+		if (HORN)
+			set_top_contexts<HornClause>();
+		else
+			set_top_contexts<Disjunction>();
+		trace.end();
 	}
 
-	all_contexts[0].pop_back();
+       //secondary contexts depend on the order of goals
+       if (TOLD_OPT && !SECONDARY_OPT && !goals_set) {
+	   trace.begin("told hierarchy");
+	   told = new ToldHierarchy(ontology, goals);
+	   goals = told->order();
+	   trace.end();
+       }
+
+       //classes are written as they are classified
+       if (OUTPUT && FORMAT == Formatter::JSONL)
+	   formatter.open_stream(output_set ? output : cout);
+
+       trace.begin("classify");
+       if (WORKERS > 1 && !goals_set) {
+	   Partition partition(ontology, factory);
+	   vector<vector<const Concept*> > components = partition.components(goals);
+	   vector<vector<const Concept*> > jobs = Partition::jobs(components, WORKERS);
+	   cerr << components.size() << " COMPONENTS in " << jobs.size() << " WORKERS" << endl;
+	   classify_parallel(jobs, goals.size());
+       }
+       else
+	   classify(goals, output_set ? output : cout, true);
+       print_progress(100);
+       cerr << endl;
+       trace.end();
+       if (store.writes)
+	   cerr << "STORED " << store.writes << " contexts (" << Memory::megabytes(store.bytes_written) << "), loaded "
+	       << store.reads << " (" << Memory::megabytes(store.bytes_read) << ")" << endl;
+
+       if (told) {
+	   vector<pair<const Concept*, const Concept*> > c = told->collapsed();
+	   FOREACH(i, c)
+	       formatter.equivalent((const AtomicConcept*) i->first, (const AtomicConcept*) i->second);
        }
-       cerr << "\b\b\b100%" << endl;
 
-       Context::UNLINK = false;
+       if (HOT && WORKERS == 1) {
+	   note_costs();
+	   statistics.report(cerr);
+       }
+
+       UNLINK = false;
        clear();
 
     timepoint[2] = clock();
+    statistics.phase("output");
 	   if (OUTPUT) {
-		   cerr << "OUTPUT to ";
-		   if (output_set) {
-			   cerr << argv[output_set] << endl;
-			   formatter.write(output);
+		   Trace::Scope scope(trace, "write");
+		   cerr << "OUTPUT to " << (output_set ? argv[output_set] : "standard output") << endl;
+		   ostream& out = output_set ? output : cout;
+		   if (FORMAT == Formatter::BINARY)
+			   formatter.write_binary(out);
+		   else if (FORMAT == Formatter::JSONL)
+			   formatter.close_stream();
+		   else
+			   formatter.write(out);
+		   if (output_set)
+			   output.close();
+	   }
+	   if (queries_set) {
+		   Trace::Scope scope(trace, "query");
+		   cerr << "QUERIES from " << argv[queries_set] << endl;
+		   answer_queries(queries_file, output_set ? output : cout);
+		   if (output_set)
 			   output.close();
-		   }
-		   else {
-			   cerr << "standard output" << endl;
-			   formatter.write();
-		   }
 	   }
 
     timepoint[3] = clock();
+    statistics.phase("");
+    trace.close();
 
 	   if (PRINT_LOG) {
 	       ofstream stats;
@@ -867,19 +1874,65 @@ int main(int argc, char* argv[]) {
 	       stats << "Classification time: " << time_interval(timepoint[1], timepoint[2]) << "ms" << endl;
 	       stats << endl;
 	       stats << "Contexts: " << context_init_number << " " << context_succ_number << endl;;
-	       stats << "Avg axioms: " << axiom_init_number / context_init_number << " " << axiom_succ_number / context_succ_number << endl;
+	       stats << "Avg axioms: " << average(axiom_init_number, context_init_number) << " " << average(axiom_succ_number, context_succ_number) << endl;
 	       stats << "Max axioms: " << max_init_axioms << " " << max_succ_axioms << endl;
 	       stats << endl; 
 	       stats << "Axioms: " << axiom_init_number << " " << axiom_succ_number << endl;;
-	       stats << "Avg length: " << total_init_length / axiom_init_number << " " << total_succ_length / axiom_succ_number << endl;
+	       stats << "Avg length: " << average(total_init_length, axiom_init_number) << " " << average(total_succ_length, axiom_succ_number) << endl;
 	       stats << "Max length: " << max_init_length << " " << max_succ_length << endl;
+	       stats << "Redundant axioms: " << ontology.redundant << endl;
+	       stats << "Split concepts: " << ontology.split_concepts << " " << ontology.split_partners << endl;
+	       stats << "Unary and binary axioms: " << ontology.unary_axioms.size() << " " << ontology.binary_axioms.size() << endl;
 	       stats << endl; 
-	       stats << "Avg links: " << link_number / (context_init_number+context_succ_number) << endl;
+	       stats << "Avg links: " << average(link_number, context_init_number+context_succ_number) << endl;
 	       stats << "Max forward links: " << max_forward_links << endl;
 	       stats << "Max backward links: " << max_backward_links << endl;
-	       stats << "Avg topush: " << topush_number / context_succ_number << endl;
+	       stats << "Avg topush: " << average(topush_number, context_succ_number) << endl;
 	       stats << "Max topush: " << max_topush << endl;
 
 	       stats.close();
 	   }
+
+	   if (stats_set) {
+	       ofstream json(argv[stats_set]);
+	       if (!json.is_open()) {
+		   cerr << "Error opening statistics file: " << argv[stats_set] << endl;
+		   return 0;
+	       }
+	       string command;
+	       for (int i = 1; i < argc; i++)
+		   command += string(i > 1 ? " " : "") + argv[i];
+
+	       statistics.setting("schedule", schedule_names[SCHEDULE]);
+	       statistics.setting("format", FORMAT == Formatter::BINARY ? "binary" : FORMAT == Formatter::JSONL ? "jsonl" : "owl");
+	       statistics.set("workers", WORKERS);
+	       statistics.set("redundant_axioms", ontology.redundant);
+	       statistics.set("split_clause_cost", Ontology::clause_cost);
+	       statistics.set("split_concepts", ontology.split_concepts);
+	       statistics.set("split_partners", ontology.split_partners);
+	       statistics.set("unary_axioms", ontology.unary_axioms.size());
+	       statistics.set("binary_axioms", ontology.binary_axioms.size());
+	       statistics.set("contexts_root", context_init_number);
+	       statistics.set("contexts_successor", context_succ_number);
+	       statistics.set("clauses_root", axiom_init_number);
+	       statistics.set("clauses_successor", axiom_succ_number);
+	       statistics.set("max_clauses_root", max_init_axioms);
+	       statistics.set("max_clauses_successor", max_succ_axioms);
+	       statistics.set("literals_root", (long long) total_init_length);
+	       statistics.set("literals_successor", (long long) total_succ_length);
+	       statistics.set("max_length_root", max_init_length);
+	       statistics.set("max_length_successor", max_succ_length);
+	       statistics.set("links", link_number);
+	       statistics.set("max_forward_links", max_forward_links);
+	       statistics.set("max_backward_links", max_backward_links);
+	       statistics.set("topush", topush_number);
+	       statistics.set("max_topush", max_topush);
+	       statistics.set("stored_contexts", store.writes);
+	       statistics.set("loaded_contexts", store.reads);
+	       statistics.set("stored_bytes", store.bytes_written);
+	       statistics.set("loaded_bytes", store.bytes_read);
+	       statistics.set("max_rss_kb", Statistics::max_rss());
+	       statistics.write(json, command);
+	       json.close();
+	   }
 }
@@ -61,6 +61,8 @@ void RoleHierarchy::add(const Role* r, const Role* s) {
 
 //IDs must be in [1, next_id)
 void RoleHierarchy::closure() {
+  if (closed)
+    return;
   int n = Role::number();
   all = new bool* [n];
   all[0] = new bool [n*n];
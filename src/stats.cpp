@@ -0,0 +1,208 @@
+/*
+ * Copyright (c) 2010 Frantisek Simancik
+ * <frantisek.simancik@comlab.ox.ac.uk>, Yevgeny Kazakov
+ * <yevgeny.kazakov@comlab.ox.ac.uk> and University of Oxford
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <algorithm>
+#include <sys/time.h>
+#include <sys/resource.h>
+
+#include "header.h"
+#include "stats.h"
+#include "memory.h"
+
+const char* Statistics::rule_names[RULES] = { "resolve_unary", "resolve_binary", "push", "link", "not_occurs" };
+const char* Statistics::event_names[EVENTS] = { "not_occurs_hits", "not_occurs_misses", "pusher_products", "splits", "unsatisfiable" };
+
+Statistics::Statistics() : hot_limit(0) {
+    reset();
+}
+
+//of the rules and events, as in a worker process that starts to count its own
+void Statistics::reset() {
+    for (int i = 0; i < RULES; i++) {
+	calls[i] = 0;
+	clauses[i] = 0;
+	seconds[i] = 0;
+    }
+    for (int i = 0; i < EVENTS; i++)
+	events[i] = 0;
+}
+
+double Statistics::wall() {
+    struct timeval t;
+    gettimeofday(&t, NULL);
+    return t.tv_sec + t.tv_usec / 1e6;
+}
+
+//of this process and the worker processes it has waited for
+double Statistics::cpu() {
+    double r = 0;
+    struct rusage u;
+    getrusage(RUSAGE_SELF, &u);
+    r += u.ru_utime.tv_sec + u.ru_utime.tv_usec / 1e6 + u.ru_stime.tv_sec + u.ru_stime.tv_usec / 1e6;
+    getrusage(RUSAGE_CHILDREN, &u);
+    r += u.ru_utime.tv_sec + u.ru_utime.tv_usec / 1e6 + u.ru_stime.tv_sec + u.ru_stime.tv_usec / 1e6;
+    return r;
+}
+
+//in kilobytes, of this process or the largest worker it has waited for
+long Statistics::max_rss() {
+    struct rusage u;
+    getrusage(RUSAGE_SELF, &u);
+    long r = u.ru_maxrss;
+    getrusage(RUSAGE_CHILDREN, &u);
+    return max(r, u.ru_maxrss);
+}
+
+//the counters of the rules and events, the times in microseconds
+void Statistics::counters(vector<long long>& v) const {
+    for (int i = 0; i < RULES; i++) {
+	v.push_back(calls[i]);
+	v.push_back(clauses[i]);
+	v.push_back((long long) (seconds[i] * 1e6));
+    }
+    for (int i = 0; i < EVENTS; i++)
+	v.push_back(events[i]);
+}
+
+//adds the counters of another process from v at i; returns where they end
+int Statistics::add(const vector<long long>& v, int i) {
+    for (int j = 0; j < RULES; j++) {
+	calls[j] += v[i++];
+	clauses[j] += v[i++];
+	seconds[j] += v[i++] / 1e6;
+    }
+    for (int j = 0; j < EVENTS; j++)
+	events[j] += v[i++];
+    return i;
+}
+
+//ends the current phase and starts the named one, if any
+void Statistics::phase(const string& name) {
+    double w = wall(), c = cpu();
+    if (!phases.empty() && phases.back().wall < 0) {
+	phases.back().wall = w - phase_wall;
+	phases.back().cpu = c - phase_cpu;
+    }
+    if (!name.empty()) {
+	Phase p;
+	p.name = name;
+	p.wall = p.cpu = -1;
+	phases.push_back(p);
+	phase_wall = w;
+	phase_cpu = c;
+    }
+}
+
+void Statistics::set(const string& name, long long value) {
+    values.push_back(make_pair(name, value));
+}
+
+void Statistics::setting(const string& name, const string& value) {
+    settings.push_back(make_pair(name, value));
+}
+
+//as a JSON string
+string Statistics::quote(const string& s) {
+    string r = "\"";
+    FOREACH(c, s)
+	if (*c == '"' || *c == '\\')
+	    r += string("\\") + *c;
+	else if ((unsigned char) *c < ' ')
+	    r += ' ';
+	else
+	    r += *c;
+    return r + "\"";
+}
+
+void Statistics::write(ostream& output, const string& command) {
+    output.setf(ios::fixed);
+    output.precision(3);
+    output << "{" << endl;
+    output << "  \"command\": " << quote(command) << "," << endl;
+
+    output << "  \"settings\": {";
+    for (int i = 0; i < settings.size(); i++)
+	output << (i ? "," : "") << endl << "    " << quote(settings[i].first) << ": " << quote(settings[i].second);
+    output << endl << "  }," << endl;
+
+    output << "  \"phases\": {";
+    for (int i = 0; i < phases.size(); i++)
+	output << (i ? "," : "") << endl << "    " << quote(phases[i].name) << ": { \"wall_ms\": " << phases[i].wall * 1000 << ", \"cpu_ms\": " << phases[i].cpu * 1000 << " }";
+    output << endl << "  }," << endl;
+
+    output << "  \"rules\": {";
+    for (int i = 0; i < RULES; i++)
+	output << (i ? "," : "") << endl << "    " << quote(rule_names[i]) << ": { \"calls\": " << calls[i] << ", \"clauses\": " << clauses[i] << ", \"ms\": " << seconds[i] * 1000 << " }";
+    output << endl << "  }," << endl;
+
+    output << "  \"events\": {";
+    for (int i = 0; i < EVENTS; i++)
+	output << (i ? "," : "") << endl << "    " << quote(event_names[i]) << ": " << events[i];
+    output << endl << "  }," << endl;
+
+    output << "  \"totals\": {";
+    for (int i = 0; i < values.size(); i++)
+	output << (i ? "," : "") << endl << "    " << quote(values[i].first) << ": " << values[i].second;
+    output << endl << "  }," << endl;
+
+    output << "  \"memory\": {";
+    Memory::write(output);
+    output << endl << "  }";
+
+    if (hot_limit > 0) {
+	vector<ContextCost> v(hot_contexts);
+	sort(v.begin(), v.end(), Slower());
+	output << "," << endl << "  \"hot_contexts\": [";
+	for (int i = 0; i < v.size(); i++)
+	    output << (i ? "," : "") << endl << "    { \"context\": " << quote(v[i].name) << ", \"ms\": " << v[i].seconds * 1000
+		<< ", \"clauses\": " << v[i].clauses << ", \"rejected\": " << v[i].rejected
+		<< ", \"forward_links\": " << v[i].forward_links << ", \"backward_links\": " << v[i].backward_links
+		<< ", \"topush\": " << v[i].topush << " }";
+	output << endl << "  ]";
+    }
+    output << endl << "}" << endl;
+}
+
+//whether a context saturated in the given time would be among the slowest kept
+bool Statistics::hot(double seconds) const {
+    return hot_limit > 0 && (hot_contexts.size() < hot_limit || seconds > hot_contexts.front().seconds);
+}
+
+void Statistics::context(const ContextCost& c) {
+    hot_contexts.push_back(c);
+    push_heap(hot_contexts.begin(), hot_contexts.end(), Slower());
+    if (hot_contexts.size() > hot_limit) {
+	pop_heap(hot_contexts.begin(), hot_contexts.end(), Slower());
+	hot_contexts.pop_back();
+    }
+}
+
+void Statistics::report(ostream& output) {
+    vector<ContextCost> v(hot_contexts);
+    sort(v.begin(), v.end(), Slower());
+    output << "HOT CONTEXTS" << endl;
+    ios::fmtflags flags = output.flags();
+    output.setf(ios::fixed);
+    streamsize precision = output.precision(1);
+    FOREACH(i, v)
+	output << "  " << i->seconds * 1000 << "ms clauses " << i->clauses << " rejected " << i->rejected
+	    << " out " << i->forward_links << " in " << i->backward_links << " topush " << i->topush
+	    << "  " << i->name << endl;
+    output.flags(flags);
+    output.precision(precision);
+}
@@ -0,0 +1,113 @@
+/*
+ * Copyright (c) 2010 Frantisek Simancik
+ * <frantisek.simancik@comlab.ox.ac.uk>, Yevgeny Kazakov
+ * <yevgeny.kazakov@comlab.ox.ac.uk> and University of Oxford
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef STATS_H_
+#define STATS_H_
+
+#include <iostream>
+#include <string>
+#include <vector>
+
+using namespace std;
+
+// Counters and timers of the inference rules, and wall-clock and CPU time
+// of the phases of a run, written as a JSON object.
+class Statistics {
+  public:
+  enum Rule { RESOLVE_UNARY, RESOLVE_BINARY, PUSH, LINK, NOT_OCCURS, RULES };
+  enum Event { NOT_OCCURS_HIT, NOT_OCCURS_MISS, PUSHER_PRODUCT, SPLIT, UNSATISFIABLE, EVENTS };
+
+  class Timer;
+
+  struct ContextCost {
+      string name;
+      double seconds;
+      long long clauses, rejected;
+      int forward_links, backward_links, topush; //successors, predecessors, clauses to push back
+  };
+
+  Statistics();
+
+  void event(Event e) { events[e]++; }
+  void derived(Rule r) { clauses[r]++; }
+
+  void phase(const string& name);
+  void set(const string& name, long long value);
+  void setting(const string& name, const string& value);
+  void write(ostream& output, const string& command);
+
+  void keep_hot(int n) { hot_limit = n; }
+  void reset();
+  void counters(vector<long long>& v) const;
+  int add(const vector<long long>& v, int i);
+  bool hot(double seconds) const;
+  void context(const ContextCost& c);
+  void report(ostream& output);
+
+  static double wall();
+  static double cpu();
+  static long max_rss();
+  static string quote(const string& s);
+
+  private:
+  static const char* rule_names[RULES];
+  static const char* event_names[EVENTS];
+
+  long long calls[RULES];
+  long long clauses[RULES];
+  double seconds[RULES];
+  long long events[EVENTS];
+
+  struct Phase {
+      string name;
+      double wall, cpu;
+  };
+  vector<Phase> phases;
+  double phase_wall, phase_cpu;
+  vector<pair<string, long long> > values;
+  vector<pair<string, string> > settings;
+
+  struct Slower {
+      bool operator()(const ContextCost& a, const ContextCost& b) const {
+	  return a.seconds > b.seconds;
+      }
+  };
+  int hot_limit;
+  vector<ContextCost> hot_contexts; //heap with the fastest on top
+};
+
+// Counts a call of a rule and adds its duration; does nothing without statistics.
+class Statistics::Timer {
+  Statistics* s;
+  Rule r;
+  double start;
+
+  public:
+  Timer(Statistics* s, Rule r) : s(s), r(r) {
+      if (s) {
+	  s->calls[r]++;
+	  start = wall();
+      }
+  }
+  ~Timer() {
+      if (s)
+	  s->seconds[r] += wall() - start;
+  }
+};
+
+#endif /* STATS_H_ */
@@ -0,0 +1,89 @@
+/*
+ * Copyright (c) 2010 Frantisek Simancik
+ * <frantisek.simancik@comlab.ox.ac.uk>, Yevgeny Kazakov
+ * <yevgeny.kazakov@comlab.ox.ac.uk> and University of Oxford
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <iostream>
+#include <cstdlib>
+#include <cstring>
+#include <cerrno>
+#include <unistd.h>
+
+#include "store.h"
+
+Store::~Store() {
+    if (fd >= 0)
+	close(fd);
+}
+
+Store::Record Store::write(const vector<int>& data) {
+    if (fd < 0) {
+	const char* dir = getenv("TMPDIR");
+	string path = string(dir && *dir ? dir : "/tmp") + "/condor-XXXXXX";
+	vector<char> name(path.begin(), path.end());
+	name.push_back(0);
+	fd = mkstemp(&name[0]);
+	if (fd < 0) {
+	    cerr << "Error creating a temporary file in " << path << ": " << strerror(errno) << endl;
+	    exit(1);
+	}
+	unlink(&name[0]);
+    }
+
+    Record r;
+    r.offset = end;
+    r.size = data.size();
+    const char* p = (const char*) &data[0];
+    size_t n = data.size() * sizeof(int);
+    off_t at = end;
+    while (n > 0) {
+	ssize_t k = pwrite(fd, p, n, at);
+	if (k < 0 && errno == EINTR)
+	    continue;
+	if (k <= 0) {
+	    cerr << "Error writing contexts to the temporary file: " << strerror(errno) << endl;
+	    exit(1);
+	}
+	p += k;
+	n -= k;
+	at += k;
+    }
+    end = at;
+    writes++;
+    bytes_written += data.size() * sizeof(int);
+    return r;
+}
+
+void Store::read(const Record& r, vector<int>& data) {
+    data.resize(r.size);
+    char* p = (char*) &data[0];
+    size_t n = r.size * sizeof(int);
+    off_t at = r.offset;
+    while (n > 0) {
+	ssize_t k = pread(fd, p, n, at);
+	if (k < 0 && errno == EINTR)
+	    continue;
+	if (k <= 0) {
+	    cerr << "Error reading contexts from the temporary file: " << strerror(errno) << endl;
+	    exit(1);
+	}
+	p += k;
+	n -= k;
+	at += k;
+    }
+    reads++;
+    bytes_read += r.size * sizeof(int);
+}
@@ -0,0 +1,51 @@
+/*
+ * Copyright (c) 2010 Frantisek Simancik
+ * <frantisek.simancik@comlab.ox.ac.uk>, Yevgeny Kazakov
+ * <yevgeny.kazakov@comlab.ox.ac.uk> and University of Oxford
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef STORE_H_
+#define STORE_H_
+
+#include <vector>
+
+using namespace std;
+
+// Records of integers in a temporary file, which is removed as soon as it
+// is created. Saturated contexts are written here when the memory is
+// capped (-m) and read back when they are needed again. The file is
+// opened by the first write, so every worker process has its own.
+class Store {
+  int fd;
+  long long end;
+
+  public:
+  struct Record {
+      long long offset;
+      int size;
+      Record() : offset(-1), size(0) {}
+      bool empty() const { return offset < 0; }
+  };
+
+  long long writes, reads, bytes_written, bytes_read;
+
+  Store() : fd(-1), end(0), writes(0), reads(0), bytes_written(0), bytes_read(0) {}
+  ~Store();
+
+  Record write(const vector<int>& data);
+  void read(const Record& r, vector<int>& data);
+};
+
+#endif /* STORE_H_ */
@@ -0,0 +1,219 @@
+/*
+ * Copyright (c) 2010 Frantisek Simancik
+ * <frantisek.simancik@comlab.ox.ac.uk>, Yevgeny Kazakov
+ * <yevgeny.kazakov@comlab.ox.ac.uk> and University of Oxford
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <algorithm>
+#include <climits>
+
+#include "taxonomy.h"
+
+const int Taxonomy::NOTHING, Taxonomy::THING, Taxonomy::UNKNOWN;
+
+//rep and parents as built by the Formatter: parents are given for the
+//representatives only, and name the representatives of the direct superclasses
+Taxonomy::Taxonomy(const vector<string>& names, const vector<int>& rep, const vector<vector<int> >& parents) :
+    n(names.size()), names(names), rep(rep), parents(parents) {
+    for (int i = 0; i < n; i++)
+	index[names[i]] = i;
+
+    members.resize(n);
+    children.resize(n);
+    for (int i = 0; i < n; i++)
+	if (rep[i] == NOTHING)
+	    nothing.push_back(i);
+	else if (rep[i] == THING)
+	    thing.push_back(i);
+	else {
+	    members[rep[i]].push_back(i);
+	    if (rep[i] == i)
+		FOREACH(j, parents[i])
+		    children[*j].push_back(i);
+	}
+    label();
+}
+
+//a representative is finished after all its subclasses, so their
+//intervals are merged into its own when it is numbered
+void Taxonomy::label() {
+    post.assign(n, -1);
+    offsets.push_back(0);
+    vector<int> low(n, -1);
+    vector<pair<int, int> > stack, merged;
+    int counter = 0;
+
+    for (int s = 0; s < n; s++) {
+	if (rep[s] != s || !parents[s].empty())
+	    continue;
+	stack.push_back(make_pair(s, 0));
+	low[s] = counter;
+	while (!stack.empty()) {
+	    int v = stack.back().first;
+	    int& k = stack.back().second;
+	    if (k < children[v].size()) {
+		int w = children[v][k++];
+		if (low[w] < 0) {
+		    low[w] = counter;
+		    stack.push_back(make_pair(w, 0));
+		}
+		continue;
+	    }
+	    post[v] = counter++;
+	    by_post.push_back(v);
+
+	    merged.clear();
+	    merged.push_back(make_pair(low[v], post[v]));
+	    FOREACH(w, children[v])
+		for (int i = offsets[post[*w]]; i < offsets[post[*w] + 1]; i++)
+		    if (intervals[i].first < low[v] || intervals[i].second > post[v])
+			merged.push_back(intervals[i]);
+	    sort(merged.begin(), merged.end());
+	    int first = intervals.size();
+	    FOREACH(i, merged)
+		if (intervals.size() > first && i->first <= intervals.back().second + 1)
+		    intervals.back().second = max(intervals.back().second, i->second);
+		else
+		    intervals.push_back(*i);
+	    offsets.push_back(intervals.size());
+	    stack.pop_back();
+	}
+    }
+}
+
+//whether a representative has a subclass numbered p
+bool Taxonomy::covered(int r, int p) const {
+    vector<pair<int, int> >::const_iterator b = intervals.begin() + offsets[post[r]];
+    vector<pair<int, int> >::const_iterator e = intervals.begin() + offsets[post[r] + 1];
+    vector<pair<int, int> >::const_iterator i = upper_bound(b, e, make_pair(p, INT_MAX));
+    return i != b && (i - 1)->second >= p;
+}
+
+//representatives that subsume a representative, including itself
+vector<int> Taxonomy::ancestors(int r) const {
+    vector<int> result(1, r);
+    unordered_set<int> seen;
+    seen.insert(r);
+    for (int i = 0; i < result.size(); i++)
+	FOREACH(j, parents[result[i]])
+	    if (seen.insert(*j).second)
+		result.push_back(*j);
+    return result;
+}
+
+void Taxonomy::add_members(int r, int except, vector<int>& result) const {
+    const vector<int>& m = r == NOTHING ? nothing : r == THING ? thing : members[r];
+    FOREACH(i, m)
+	if (*i != except)
+	    result.push_back(*i);
+}
+
+//owl:Thing and owl:Nothing are found as THING and NOTHING
+int Taxonomy::find(const string& name) const {
+    if (name == "owl:Thing")
+	return THING;
+    if (name == "owl:Nothing")
+	return NOTHING;
+    unordered_map<string, int>::const_iterator i = index.find(name);
+    return i == index.end() ? UNKNOWN : i->second;
+}
+
+string Taxonomy::name(int c) const {
+    if (c == THING)
+	return "owl:Thing";
+    if (c == NOTHING)
+	return "owl:Nothing";
+    return names[c];
+}
+
+//whether c is a subclass of d, or equivalent to it
+bool Taxonomy::subsumed(int c, int d) const {
+    int a = node(c), b = node(d);
+    if (a == NOTHING || b == THING)
+	return true;
+    if (b == NOTHING || a == THING)
+	return false;
+    return covered(b, post[a]);
+}
+
+//the classes that c is a subclass of, other than itself
+vector<int> Taxonomy::subsumers(int c) const {
+    vector<int> result;
+    int a = node(c);
+    if (a == NOTHING) {
+	for (int i = 0; i < n; i++)
+	    if (i != c)
+		result.push_back(i);
+	return result;
+    }
+    if (a != THING) {
+	vector<int> r = ancestors(a);
+	FOREACH(i, r)
+	    add_members(*i, c, result);
+    }
+    add_members(THING, c, result);
+    sort(result.begin(), result.end());
+    return result;
+}
+
+//the classes that are subclasses of d, other than itself, in the
+//order of their numbers in the labeling
+vector<int> Taxonomy::subclasses(int d) const {
+    vector<int> result;
+    int b = node(d);
+    if (b == THING) {
+	for (int i = 0; i < n; i++)
+	    if (i != d)
+		result.push_back(i);
+	return result;
+    }
+    if (b != NOTHING)
+	for (int i = offsets[post[b]]; i < offsets[post[b] + 1]; i++)
+	    for (int p = intervals[i].first; p <= intervals[i].second; p++)
+		add_members(by_post[p], d, result);
+    add_members(NOTHING, d, result);
+    return result;
+}
+
+//the most specific classes that subsume both c and d, one of every
+//equivalence class
+vector<int> Taxonomy::least_common_subsumers(int c, int d) const {
+    vector<int> result;
+    if (subsumed(c, d))
+	result.push_back(d);
+    else if (subsumed(d, c))
+	result.push_back(c);
+    else {
+	vector<int> a = ancestors(node(c)), b = ancestors(node(d));
+	unordered_set<int> common(a.begin(), a.end());
+	vector<int> both;
+	FOREACH(i, b)
+	    if (common.find(*i) != common.end())
+		both.push_back(*i);
+	common = unordered_set<int>(both.begin(), both.end());
+	FOREACH(i, both) {
+	    bool least = true;
+	    FOREACH(j, children[*i])
+		if (common.find(*j) != common.end())
+		    least = false;
+	    if (least)
+		result.push_back(*i);
+	}
+	if (result.empty())
+	    result.push_back(thing.empty() ? THING : thing[0]);
+	sort(result.begin(), result.end());
+    }
+    return result;
+}
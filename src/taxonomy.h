@@ -0,0 +1,69 @@
+/*
+ * Copyright (c) 2010 Frantisek Simancik
+ * <frantisek.simancik@comlab.ox.ac.uk>, Yevgeny Kazakov
+ * <yevgeny.kazakov@comlab.ox.ac.uk> and University of Oxford
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef TAXONOMY_H_
+#define TAXONOMY_H_
+
+#include <vector>
+#include <string>
+
+#include "header.h"
+
+using namespace std;
+
+// The computed class hierarchy, for queries after the classification.
+// Classes are numbered as in the Formatter. Every equivalence class is
+// numbered in the postorder of a depth-first search from owl:Thing, and
+// the numbers of all its subclasses are covered by a few intervals, one
+// for a tree, so that a subsumption test is a search among these.
+class Taxonomy {
+  public:
+  static const int NOTHING = -1, THING = -2, UNKNOWN = -3;
+
+  private:
+  int n;
+  vector<string> names;
+  unordered_map<string, int> index;
+  vector<int> rep; //of the equivalence class, or NOTHING or THING
+  vector<vector<int> > members, parents, children; //of representatives
+  vector<int> nothing, thing; //classes equivalent to them
+  vector<int> post; //of representatives
+  vector<int> by_post;
+  vector<int> offsets; //of the intervals, by post
+  vector<pair<int, int> > intervals;
+
+  int node(int c) const { return c < 0 ? c : rep[c]; }
+  void label();
+  bool covered(int r, int p) const;
+  vector<int> ancestors(int r) const;
+  void add_members(int r, int except, vector<int>& result) const;
+
+  public:
+  Taxonomy(const vector<string>& names, const vector<int>& rep, const vector<vector<int> >& parents);
+
+  int size() const { return n; }
+  int find(const string& name) const;
+  string name(int c) const;
+
+  bool subsumed(int c, int d) const;
+  vector<int> subsumers(int c) const;
+  vector<int> subclasses(int d) const;
+  vector<int> least_common_subsumers(int c, int d) const;
+};
+
+#endif /* TAXONOMY_H_ */
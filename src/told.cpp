@@ -0,0 +1,149 @@
+/*
+ * Copyright (c) 2010 Frantisek Simancik
+ * <frantisek.simancik@comlab.ox.ac.uk>, Yevgeny Kazakov
+ * <yevgeny.kazakov@comlab.ox.ac.uk> and University of Oxford
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <queue>
+#include <algorithm>
+
+#include "told.h"
+
+ToldHierarchy::ToldHierarchy(const Ontology& ontology, const vector<const Concept*>& goals) : goals(goals) {
+    int n = goals.size();
+    for (int i = 0; i < n; i++)
+	index[goals[i]->ID()] = i;
+
+    vector<vector<int> > edges(n);
+    FOREACH(i, ontology.told_subsumptions)
+	if (i->first->type() == 'A' && i->second->type() == 'A') {
+	    unordered_map<ConceptID, int>::iterator c = index.find(i->first->ID());
+	    unordered_map<ConceptID, int>::iterator d = index.find(i->second->ID());
+	    if (c != index.end() && d != index.end() && c->second != d->second)
+		edges[c->second].push_back(d->second);
+	}
+
+    collapse(edges);
+
+    supers.resize(n);
+    for (int i = 0; i < n; i++)
+	FOREACH(j, edges[i])
+	    if (rep[i] != rep[*j])
+		supers[rep[i]].push_back(rep[*j]);
+    for (int i = 0; i < n; i++) {
+	sort(supers[i].begin(), supers[i].end());
+	supers[i].erase(unique(supers[i].begin(), supers[i].end()), supers[i].end());
+    }
+
+    unsat.resize(n, false);
+}
+
+//strongly connected components (Tarjan, without recursion); rep is the smallest member
+void ToldHierarchy::collapse(const vector<vector<int> >& edges) {
+    int n = edges.size();
+    vector<int> low(n), number(n, -1);
+    vector<bool> on_stack(n, false);
+    vector<int> stack;
+    vector<pair<int, int> > call;
+    int counter = 0;
+
+    rep.resize(n);
+    for (int s = 0; s < n; s++) {
+	if (number[s] >= 0)
+	    continue;
+	call.push_back(make_pair(s, 0));
+	while (!call.empty()) {
+	    int v = call.back().first;
+	    int& k = call.back().second;
+	    if (k == 0) {
+		number[v] = low[v] = counter++;
+		stack.push_back(v);
+		on_stack[v] = true;
+	    }
+	    if (k < edges[v].size()) {
+		int w = edges[v][k++];
+		if (number[w] < 0)
+		    call.push_back(make_pair(w, 0));
+		else if (on_stack[w])
+		    low[v] = min(low[v], number[w]);
+		continue;
+	    }
+	    if (low[v] == number[v]) {
+		int first = stack.size();
+		do
+		    first--;
+		while (stack[first] != v);
+		int r = *min_element(stack.begin() + first, stack.end());
+		for (int i = first; i < stack.size(); i++) {
+		    rep[stack[i]] = r;
+		    on_stack[stack[i]] = false;
+		}
+		stack.resize(first);
+	    }
+	    call.pop_back();
+	    if (!call.empty())
+		low[call.back().first] = min(low[call.back().first], low[v]);
+	}
+    }
+}
+
+//representatives, every one after its told subsumers
+vector<const Concept*> ToldHierarchy::order() const {
+    int n = goals.size();
+    vector<int> pending(n, 0);
+    vector<vector<int> > subs(n);
+    for (int i = 0; i < n; i++)
+	FOREACH(j, supers[i]) {
+	    pending[i]++;
+	    subs[*j].push_back(i);
+	}
+
+    queue<int> q;
+    for (int i = 0; i < n; i++)
+	if (rep[i] == i && pending[i] == 0)
+	    q.push(i);
+
+    vector<const Concept*> r;
+    while (!q.empty()) {
+	int i = q.front();
+	q.pop();
+	r.push_back(goals[i]);
+	FOREACH(j, subs[i])
+	    if (--pending[*j] == 0)
+		q.push(*j);
+    }
+    return r;
+}
+
+//concepts that are not classified, paired with their representatives
+vector<pair<const Concept*, const Concept*> > ToldHierarchy::collapsed() const {
+    vector<pair<const Concept*, const Concept*> > r;
+    for (int i = 0; i < goals.size(); i++)
+	if (rep[i] != i)
+	    r.push_back(make_pair(goals[i], goals[rep[i]]));
+    return r;
+}
+
+bool ToldHierarchy::known_unsatisfiable(const Concept* c) const {
+    int i = rep[index.find(c->ID())->second];
+    FOREACH(j, supers[i])
+	if (unsat[*j])
+	    return true;
+    return false;
+}
+
+void ToldHierarchy::unsatisfiable(const Concept* c) {
+    unsat[rep[index.find(c->ID())->second]] = true;
+}
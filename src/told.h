@@ -0,0 +1,51 @@
+/*
+ * Copyright (c) 2010 Frantisek Simancik
+ * <frantisek.simancik@comlab.ox.ac.uk>, Yevgeny Kazakov
+ * <yevgeny.kazakov@comlab.ox.ac.uk> and University of Oxford
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef TOLD_H_
+#define TOLD_H_
+
+#include <vector>
+
+#include "header.h"
+#include "concept.h"
+#include "ontology.h"
+
+using namespace std;
+
+// Hierarchy of the goals told by SubClassOf and EquivalentClasses axioms
+// between atomic concepts. Cycles are collapsed into their first goal.
+class ToldHierarchy {
+  vector<const Concept*> goals;
+  unordered_map<ConceptID, int> index;
+  vector<int> rep;
+  vector<vector<int> > supers;
+  vector<bool> unsat;
+
+  void collapse(const vector<vector<int> >& edges);
+
+  public:
+  ToldHierarchy(const Ontology& ontology, const vector<const Concept*>& goals);
+
+  vector<const Concept*> order() const;
+  vector<pair<const Concept*, const Concept*> > collapsed() const;
+
+  bool known_unsatisfiable(const Concept* c) const;
+  void unsatisfiable(const Concept* c);
+};
+
+#endif /* TOLD_H_ */
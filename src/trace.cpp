@@ -0,0 +1,97 @@
+/*
+ * Copyright (c) 2010 Frantisek Simancik
+ * <frantisek.simancik@comlab.ox.ac.uk>, Yevgeny Kazakov
+ * <yevgeny.kazakov@comlab.ox.ac.uk> and University of Oxford
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <sstream>
+#include <cerrno>
+#include <fcntl.h>
+#include <unistd.h>
+
+#include "trace.h"
+#include "stats.h"
+
+bool Trace::open(const char* path) {
+    fd = ::open(path, O_WRONLY | O_CREAT | O_TRUNC | O_APPEND, 0644);
+    if (fd < 0)
+	return false;
+    origin = Statistics::wall();
+    emit("[\n" + metadata("condor"));
+    return true;
+}
+
+//only by the process that opened the trace, after its workers are done
+void Trace::close() {
+    if (fd < 0)
+	return;
+    emit("\n]\n");
+    ::close(fd);
+    fd = -1;
+}
+
+void Trace::emit(const string& event) {
+    const char* p = event.data();
+    size_t n = event.size();
+    while (n > 0) {
+	ssize_t k = ::write(fd, p, n);
+	if (k < 0 && errno == EINTR)
+	    continue;
+	if (k <= 0)
+	    return;
+	p += k;
+	n -= k;
+    }
+}
+
+//metadata event naming the process
+string Trace::metadata(const string& name) {
+    stringstream ss;
+    ss << "{\"name\": \"process_name\", \"ph\": \"M\", \"pid\": " << getpid() << ", \"tid\": " << getpid()
+	<< ", \"args\": {\"name\": " << Statistics::quote(name) << "}}";
+    return ss.str();
+}
+
+void Trace::name_process(const string& name) {
+    if (fd >= 0)
+	emit(",\n" + metadata(name));
+}
+
+void Trace::begin(const string& name, const string& detail) {
+    if (fd < 0)
+	return;
+    Span s;
+    s.name = name;
+    s.detail = detail;
+    s.start = Statistics::wall();
+    spans.push_back(s);
+}
+
+//spans nest, so the last one begun is the one that ends
+void Trace::end() {
+    if (fd < 0 || spans.empty())
+	return;
+    Span& s = spans.back();
+    stringstream ss;
+    ss.setf(ios::fixed);
+    ss.precision(0);
+    ss << ",\n{\"name\": " << Statistics::quote(s.name) << ", \"cat\": \"condor\", \"ph\": \"X\", \"ts\": " << (s.start - origin) * 1e6
+	<< ", \"dur\": " << (Statistics::wall() - s.start) * 1e6 << ", \"pid\": " << getpid() << ", \"tid\": " << getpid();
+    if (!s.detail.empty())
+	ss << ", \"args\": {\"detail\": " << Statistics::quote(s.detail) << "}";
+    ss << "}";
+    emit(ss.str());
+    spans.pop_back();
+}
@@ -0,0 +1,66 @@
+/*
+ * Copyright (c) 2010 Frantisek Simancik
+ * <frantisek.simancik@comlab.ox.ac.uk>, Yevgeny Kazakov
+ * <yevgeny.kazakov@comlab.ox.ac.uk> and University of Oxford
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef TRACE_H_
+#define TRACE_H_
+
+#include <string>
+#include <vector>
+
+using namespace std;
+
+// Timeline of a run in the Chrome trace event format (chrome://tracing,
+// Perfetto). Every event is appended with a single write, so worker
+// processes forked after open() add their events to the same file.
+class Trace {
+  int fd;
+  double origin;
+
+  struct Span {
+      string name, detail;
+      double start;
+  };
+  vector<Span> spans;
+
+  void emit(const string& event);
+  string metadata(const string& name);
+
+  public:
+  class Scope;
+
+  Trace() : fd(-1) {}
+
+  bool on() const { return fd >= 0; }
+  bool open(const char* path);
+  void close();
+
+  void name_process(const string& name);
+  void begin(const string& name, const string& detail = "");
+  void end();
+};
+
+// A span from construction to the end of the enclosing block.
+class Trace::Scope {
+  Trace& trace;
+
+  public:
+  Scope(Trace& trace, const string& name, const string& detail = "") : trace(trace) { trace.begin(name, detail); }
+  ~Scope() { trace.end(); }
+};
+
+#endif /* TRACE_H_ */
@@ -21,29 +21,38 @@
 
 #include <map>
 #include <vector>
+#include <new>
 
 #include "header.h"
+#include "memory.h"
 
 using namespace std;
 
-template<typename S, typename T>
+template<typename S, typename T, int M = Memory::FACTORY>
 class tracker {
-  map<S, T*> m;
+  typedef map<S, T*, less<S>, CountingAllocator<pair<const S, T*>, M> > Map;
+  Map m;
   bool last;
 
+  void discard(T* x) {
+    Memory::released(M, sizeof(T));
+    delete x;
+  }
+
   public:
   tracker() : m(), last(false) {}
   ~tracker() { clear(); }
   
   void clear() {
-    for (typename map<S, T*>::iterator i = m.begin(); i != m.end(); i++)
-      delete i->second;
+    for (typename Map::iterator i = m.begin(); i != m.end(); i++)
+      discard(i->second);
     m.clear();
   }
 
   T* operator()(const S& x) {
     if (m.find(x) == m.end()) {
       T* r = new T(x);
+      Memory::allocated(M, sizeof(T));
       m[x] = r;
       last = true;
       return r;
@@ -59,37 +68,44 @@ class tracker {
   }
 
   void erase(const S& x) {
-      typename map<S, T*>::iterator i = m.find(x);
-      delete i->second;
+      typename Map::iterator i = m.find(x);
+      discard(i->second);
       m.erase(i);
   }
 
   vector<T*> get_range() {
     vector<T*> l;
     l.reserve(m.size());
-    for (typename map<S, T*>::iterator i = m.begin(); i != m.end(); i++)
+    for (typename Map::iterator i = m.begin(); i != m.end(); i++)
       l.push_back(i->second);
 	return l;
   }
 };
 
-template<typename S, typename T>
+template<typename S, typename T, int M = Memory::FACTORY>
 class hash_tracker {
-  unordered_map<S, T*> m;
+  typedef unordered_map<S, T*, std::tr1::hash<S>, equal_to<S>, CountingAllocator<pair<const S, T*>, M> > Map;
+  Map m;
   bool last;
+
+  void discard(T* x) {
+    Memory::released(M, sizeof(T));
+    delete x;
+  }
   public:
   hash_tracker() : m(), last(false) {}
   ~hash_tracker() { clear(); }
 
   void clear() {
-    for (typename unordered_map<S, T*>::iterator i = m.begin(); i != m.end(); i++)
-      delete i->second;
+    for (typename Map::iterator i = m.begin(); i != m.end(); i++)
+      discard(i->second);
     m.clear();
   }
 
   T* operator()(const S& x) {
     if (m.find(x) == m.end()) {
       T* r = new T(x);
+      Memory::allocated(M, sizeof(T));
       m[x] = r;
       last = true;
       return r;
@@ -105,18 +121,122 @@ class hash_tracker {
   }
 
   void erase(const S& x) {
-      typename unordered_map<S, T*>::iterator i = m.find(x);
-      delete i->second;
+      typename Map::iterator i = m.find(x);
+      discard(i->second);
       m.erase(i);
   }
 
   vector<T*> get_range() {
     vector<T*> l;
     l.reserve(m.size());
-    for (typename unordered_map<S, T*>::iterator i = m.begin(); i != m.end(); i++)
+    for (typename Map::iterator i = m.begin(); i != m.end(); i++)
       l.push_back(i->second);
 	return l;
   }
 };
 
+// Objects in slabs of contiguous memory, addressed by a 32-bit index as
+// well as by their key in a hash table. The keys can be split into groups,
+// which share the indices. Objects without a key can be created and
+// released, and their slots are reused. T has an int member index, which
+// is set to its position.
+template<typename S, typename T, int M = Memory::FACTORY, typename H = std::tr1::hash<S> >
+class slab_tracker {
+  static const int SHIFT = 10, SLAB = 1 << SHIFT;
+  typedef pair<S, int> Key;
+  struct Hash {
+    size_t operator()(const Key& x) const { return H()(x.first) * 31 + x.second; }
+  };
+  typedef unordered_map<Key, int, Hash, equal_to<Key>, CountingAllocator<pair<const Key, int>, M> > Map;
+  Map m;
+  vector<T*> slabs;
+  int n;
+  vector<int> released;
+  bool last;
+
+  T* slot(int i) const { return slabs[i >> SHIFT] + (i & (SLAB - 1)); }
+
+  T* create(const S& x) {
+    int i;
+    if (released.empty()) {
+      i = n++;
+      if ((i >> SHIFT) == slabs.size()) {
+	slabs.push_back(static_cast<T*>(::operator new(SLAB * sizeof(T))));
+	Memory::allocated(M, SLAB * sizeof(T));
+      }
+    }
+    else {
+      i = released.back();
+      released.pop_back();
+    }
+    T* r = new (slot(i)) T(x);
+    r->index = i;
+    return r;
+  }
+
+  public:
+  slab_tracker() : m(), n(0), last(false) {}
+  ~slab_tracker() { clear(); }
+
+  void clear() {
+    vector<bool> free(n, false);
+    for (int i = 0; i < released.size(); i++)
+      free[released[i]] = true;
+    for (int i = 0; i < n; i++)
+      if (!free[i])
+	slot(i)->~T();
+    for (int i = 0; i < slabs.size(); i++) {
+      Memory::released(M, SLAB * sizeof(T));
+      ::operator delete(slabs[i]);
+    }
+    slabs.clear();
+    released.clear();
+    n = 0;
+    m.clear();
+  }
+
+  //the object is constructed before it is entered, it can look up others
+  T* operator()(const S& x, int group = 0) {
+    Key k(x, group);
+    typename Map::iterator i = m.find(k);
+    last = (i == m.end());
+    if (!last)
+      return slot(i->second);
+    T* r = create(x);
+    m[k] = r->index;
+    return r;
+  }
+
+  T* operator[](int i) const {
+    return slot(i);
+  }
+
+  bool was_new() {
+    return last;
+  }
+
+  //only for objects without a key
+  T* anonymous(const S& x) {
+    return create(x);
+  }
+
+  void release(T* x) {
+    int i = x->index;
+    x->~T();
+    released.push_back(i);
+  }
+
+  vector<T*> get_range() {
+    vector<bool> free(n, false);
+    for (int i = 0; i < released.size(); i++)
+      free[released[i]] = true;
+    vector<T*> l;
+    l.reserve(n - released.size());
+    for (int i = 0; i < n; i++)
+      if (!free[i])
+	l.push_back(slot(i));
+    return l;
+  }
+};
+
 #endif /* TRACKER_H_ */